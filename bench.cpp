@@ -0,0 +1,627 @@
+/**
+ * bench.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cinttypes>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "systeminfo.hpp"
+#include "procparse.hpp"
+#include "processtable.hpp"
+#include "collectorpool.hpp"
+#include "procuring.hpp"
+#include "systemcontext.hpp"
+
+/**
+ * The bench binary is linked with --wrap for the syscalls the
+ * collection code issues and for the allocator, so each wrapper
+ * below counts a call and forwards it.  Calls libc makes
+ * internally (printf's write) are not counted, the collection
+ * code's own are.  stdio is counted by what it costs the kernel:
+ * fopen and fclose one syscall each, fgets one read whenever it
+ * finds the FILE's buffer empty and has to refill it.
+ */
+static std::atomic< uint64_t > syscall_count( 0 );
+static std::atomic< uint64_t > alloc_count( 0 );
+
+#define COUNT_SYSCALL() syscall_count.fetch_add(1, std::memory_order_relaxed)
+#define COUNT_ALLOC()   alloc_count.fetch_add(1, std::memory_order_relaxed)
+
+extern "C" {
+int     __real_open (const char *path, int flags, ...);
+int     __real_openat (int dir, const char *path, int flags, ...);
+ssize_t __real_read (int fd, void *buf, size_t count);
+ssize_t __real_pread (int fd, void *buf, size_t count, off_t offset);
+int     __real_close (int fd);
+off_t   __real_lseek (int fd, off_t offset, int whence);
+long    __real_syscall (long number, ...);
+int     __real_ioctl (int fd, unsigned long request, ...);
+int     __real_uname (struct utsname *buf);
+int     __real_sysinfo (struct sysinfo *info);
+int     __real_prlimit (pid_t pid, __rlimit_resource resource, 
+                        const struct rlimit *new_limit, struct rlimit *old_limit);
+int     __real_getpriority (__priority_which_t which, id_t who);
+int     __real_sched_getscheduler (pid_t pid);
+void   *__real_malloc (size_t size);
+void   *__real_calloc (size_t n, size_t size);
+void   *__real_realloc (void *ptr, size_t size);
+int     __real_posix_memalign (void **ptr, size_t align, size_t size);
+FILE   *__real_fopen (const char *path, const char *mode);
+char   *__real_fgets (char *s, int size, FILE *fp);
+int     __real_fclose (FILE *fp);
+
+int __wrap_open (const char *path, int flags, ...)
+{
+	va_list ap;
+	va_start(ap, flags);
+	const mode_t mode = (flags & O_CREAT) ? va_arg(ap, mode_t) : 0;
+	va_end(ap);
+	COUNT_SYSCALL();
+	return __real_open(path, flags, mode);
+}
+
+int __wrap_openat (int dir, const char *path, int flags, ...)
+{
+	va_list ap;
+	va_start(ap, flags);
+	const mode_t mode = (flags & O_CREAT) ? va_arg(ap, mode_t) : 0;
+	va_end(ap);
+	COUNT_SYSCALL();
+	return __real_openat(dir, path, flags, mode);
+}
+
+ssize_t __wrap_read (int fd, void *buf, size_t count)
+{
+	COUNT_SYSCALL();
+	return __real_read(fd, buf, count);
+}
+
+ssize_t __wrap_pread (int fd, void *buf, size_t count, off_t offset)
+{
+	COUNT_SYSCALL();
+	return __real_pread(fd, buf, count, offset);
+}
+
+int __wrap_close (int fd)
+{
+	COUNT_SYSCALL();
+	return __real_close(fd);
+}
+
+off_t __wrap_lseek (int fd, off_t offset, int whence)
+{
+	COUNT_SYSCALL();
+	return __real_lseek(fd, offset, whence);
+}
+
+/** syscall(2) takes at most six arguments, all passed as longs **/
+long __wrap_syscall (long number, ...)
+{
+	long a[6];
+	va_list ap;
+
+	va_start(ap, number);
+	for (int i(0); i < 6; i++)
+		a[i] = va_arg(ap, long);
+	va_end(ap);
+	COUNT_SYSCALL();
+	return __real_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+int __wrap_ioctl (int fd, unsigned long request, ...)
+{
+	va_list ap;
+	va_start(ap, request);
+	void *arg = va_arg(ap, void *);
+	va_end(ap);
+	COUNT_SYSCALL();
+	return __real_ioctl(fd, request, arg);
+}
+
+int __wrap_uname (struct utsname *buf)
+{
+	COUNT_SYSCALL();
+	return __real_uname(buf);
+}
+
+int __wrap_sysinfo (struct sysinfo *info)
+{
+	COUNT_SYSCALL();
+	return __real_sysinfo(info);
+}
+
+int __wrap_prlimit (pid_t pid, __rlimit_resource resource, 
+                    const struct rlimit *new_limit, struct rlimit *old_limit)
+{
+	COUNT_SYSCALL();
+	return __real_prlimit(pid, resource, new_limit, old_limit);
+}
+
+int __wrap_getpriority (__priority_which_t which, id_t who)
+{
+	COUNT_SYSCALL();
+	return __real_getpriority(which, who);
+}
+
+int __wrap_sched_getscheduler (pid_t pid)
+{
+	COUNT_SYSCALL();
+	return __real_sched_getscheduler(pid);
+}
+
+void *__wrap_malloc (size_t size)
+{
+	COUNT_ALLOC();
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc (size_t n, size_t size)
+{
+	COUNT_ALLOC();
+	return __real_calloc(n, size);
+}
+
+void *__wrap_realloc (void *ptr, size_t size)
+{
+	COUNT_ALLOC();
+	return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign (void **ptr, size_t align, size_t size)
+{
+	COUNT_ALLOC();
+	return __real_posix_memalign(ptr, align, size);
+}
+
+FILE *__wrap_fopen (const char *path, const char *mode)
+{
+	COUNT_SYSCALL();
+	return __real_fopen(path, mode);
+}
+
+char *__wrap_fgets (char *s, int size, FILE *fp)
+{
+	/** glibc's read pointers, an empty buffer means a read(2) **/
+	if (fp->_IO_read_ptr >= fp->_IO_read_end)
+		COUNT_SYSCALL();
+	return __real_fgets(s, size, fp);
+}
+
+int __wrap_fclose (FILE *fp)
+{
+	COUNT_SYSCALL();
+	return __real_fclose(fp);
+}
+}
+
+/**
+ * sscanf_stat_parse - the single format string parser that
+ * proc_stat_parse replaced, kept here as the baseline.
+ */
+static int sscanf_stat_parse (const char *buf, struct ProcStatData *data)
+{
+	memset(data, 0, sizeof(struct ProcStatData));
+
+	return sscanf(buf, "%d %s %c %d %d %d %d %d %d %lu %lu %lu %lu %lu %lu %lu "
+		   "%lu %lu %lu %lu %lu %llu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu "
+		   "%lu %lu %lu %lu %d %d %u %u %llu %lu %lu", 
+		&data->pid, data->executable, &data->state, &data->parent_pid, 
+		&data->group_id, &data->session_id, &data->tty_nr, &data->foreground_id,
+		&data->flags, &data->minor_faults, &data->child_minor_faults, 
+		&data->major_faults, &data->child_major_faults, &data->uptime, 
+		&data->scheduled_time, &data->child_uptime, &data->child_scheduled_time, 
+		&data->priority, &data->nice, &data->number_threads, &data->itrealvalue, 
+		&data->start_time, &data->virtual_mem_size_bytes, &data->resident_mem_size, 
+		&data->resident_mem_soft_limit, &data->startcode, &data->endcode, 
+		&data->startstack, &data->curr_esp, &data->curr_eip, &data->signal_unused, 
+		&data->signal_ignore_unused, &data->signal_caught_unused, 
+		&data->channel, &data->pages_swapped, &data->cumulative_child_swapped_pages,
+		&data->exit_signal, &data->processor_last_executed_on, &data->rt_schedule, 
+		&data->policy, &data->delayed_io_ticks, &data->guest_time, 
+		&data->child_guest_time);
+}
+
+/**
+ * Result - one line of output.  Latencies are per operation;
+ * each latency sample is the mean of a batch of operations so
+ * that clock overhead stays out of sub-microsecond numbers.
+ */
+struct Result{
+   std::string group;
+   std::string name;
+   size_t      pids;
+   size_t      ops;
+   double      mean_ns;
+   double      p50_ns;
+   double      p99_ns;
+   double      syscalls; /* per op */
+   double      allocs;   /* per op */
+};
+
+/**
+ * report - print r as one JSON object per line, so runs can be
+ * diffed or loaded without parsing free text.
+ */
+static void report (const Result &r)
+{
+	printf("{\"group\":\"%s\",\"name\":\"%s\",\"pids\":%zu,\"ops\":%zu,"
+	       "\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,"
+	       "\"syscalls_per_op\":%.2f,\"allocs_per_op\":%.2f}\n",
+	       r.group.c_str(), r.name.c_str(), r.pids, r.ops, r.mean_ns, 
+	       r.p50_ns, r.p99_ns, r.syscalls, r.allocs);
+	fflush(stdout);
+}
+
+/**
+ * measure - run fn ops times in batches of batch after one warm up
+ * call and report latency percentiles plus syscalls and
+ * allocations per call.
+ */
+template <class Fn> static Result
+measure (const char *group, const std::string &name, const size_t pids,
+         size_t ops, size_t batch, Fn fn)
+{
+	std::vector< double > samples;
+	Result r;
+
+	if (batch == 0)
+		batch = 1;
+	if (ops < batch)
+		ops = batch;
+	samples.reserve(ops / batch);
+	fn();
+
+	const uint64_t syscalls = syscall_count.load();
+	const uint64_t allocs = alloc_count.load();
+	double total = 0;
+
+	for (size_t done(0); done + batch <= ops; done += batch) {
+		const auto start( std::chrono::steady_clock::now() );
+
+		for (size_t i(0); i < batch; i++)
+			fn();
+
+		const auto stop( std::chrono::steady_clock::now() );
+		const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+
+		samples.push_back(ns / batch);
+		total += ns;
+	}
+
+	r.ops = samples.size() * batch;
+	r.syscalls = (double)(syscall_count.load() - syscalls) / r.ops;
+	r.allocs = (double)(alloc_count.load() - allocs) / r.ops;
+	std::sort(samples.begin(), samples.end());
+	r.group = group;
+	r.name = name;
+	r.pids = pids;
+	r.mean_ns = total / r.ops;
+	r.p50_ns = samples[samples.size() / 2];
+	r.p99_ns = samples[(samples.size() * 99) / 100 < samples.size() ? 
+	                   (samples.size() * 99) / 100 : samples.size() - 1];
+	report(r);
+	return r;
+}
+
+/**
+ * host_pids - n pids to sample, the host's pids repeated when it
+ * has fewer than n.
+ */
+static std::vector< int > host_pids (const size_t n)
+{
+	ProcessTable table;
+	std::vector< int > pids;
+
+	table.refresh();
+	const uint64_t *ids = table.column(pid1);
+	for (size_t i(0); i < n && table.size(); i++)
+		pids.push_back((int)ids[i % table.size()]);
+	return pids;
+}
+
+static void bench_stat_parse (const size_t iterations)
+{
+	char path[64], buf[PROC_BUFFER_SIZE];
+	struct ProcStatData data;
+	ssize_t len;
+	volatile long sink = 0;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", getpid());
+	if ((len = proc_read_file(path, buf, sizeof(buf))) < 0) {
+		perror("Failed to read /proc/self/stat");
+		return;
+	}
+
+	measure("parse", "proc_stat_parse", 1, iterations, 1000, [&]() {
+		proc_stat_parse(buf, len, &data);
+		sink += data.minor_faults;
+	});
+	measure("parse", "sscanf_stat_parse", 1, iterations, 1000, [&]() {
+		sscanf_stat_parse(buf, &data);
+		sink += data.minor_faults;
+	});
+
+	/** an executable with a space and a ')' shifts every sscanf field **/
+	const char *odd = "42 (a) b) S 1 42 42 0 -1 4194560 100 0 0 0 7 3 0 0 20 0 1 0 "
+	                  "5000 1000 10 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 3 0 0 0 0 0";
+	proc_stat_parse(odd, strlen(odd), &data);
+	printf("{\"group\":\"check\",\"name\":\"proc_stat_parse_odd_comm\","
+	       "\"executable\":\"%s\",\"state\":\"%c\",\"minor_faults\":%lu}\n",
+	       data.executable, data.state, data.minor_faults);
+	sscanf_stat_parse(odd, &data);
+	printf("{\"group\":\"check\",\"name\":\"sscanf_stat_parse_odd_comm\","
+	       "\"executable\":\"%s\",\"state\":\"%c\",\"minor_faults\":%lu}\n",
+	       data.executable, data.state, data.minor_faults);
+}
+
+static void bench_meminfo_parse (const size_t iterations)
+{
+	char buf[PROC_BUFFER_SIZE];
+	uint64_t meminfo[Hugepagesize - MemTotal + 1];
+	ssize_t len;
+	volatile uint64_t sink = 0;
+
+	if ((len = proc_read_file("/proc/meminfo", buf, sizeof(buf))) < 0) {
+		perror("Failed to read /proc/meminfo");
+		return;
+	}
+
+	measure("parse", "proc_meminfo_parse", 1, iterations, 100, [&]() {
+		proc_meminfo_parse(buf, len, meminfo);
+		sink += meminfo[0];
+	});
+
+	/** the old way: one prefix-matched scan of the file per trait **/
+	measure("parse", "meminfo_per_key_scan", 1, iterations, 100, [&]() {
+		for (int t(MemTotal); t <= Hugepagesize; t++) {
+			const char *name = SystemInfo::getName((Trait)t);
+
+			for_each_named_line(buf, len, [&](const char *key, size_t, 
+			                                  const char *val) {
+				if (strncmp(key, name, strlen(name)))
+					return true;
+				meminfo[t - MemTotal] = strtoull(val, NULL, 10);
+				return false;
+			});
+		}
+		sink += meminfo[0];
+	});
+
+	/** every kernel reserves vmalloc space, 0 means the key never matched **/
+	proc_meminfo_parse(buf, len, meminfo);
+	const uint64_t parsed = meminfo[VMallocTotal - MemTotal];
+	const uint64_t cached = SystemInfo::getSystemValue(VMallocTotal, getpid()).u;
+	printf("{\"group\":\"check\",\"name\":\"meminfo_vmalloc_total\","
+	       "\"parsed_kb\":%" PRIu64 ",\"cached_kb\":%" PRIu64 ",\"ok\":%s}\n",
+	       parsed, cached, parsed && cached ? "true" : "false");
+}
+
+/**
+ * bench_sources - what one getSystemProperty call costs for a
+ * trait of each source; static traits show the cache.
+ */
+static void bench_sources (const size_t iterations)
+{
+	static const Trait traits[] = {
+		LevelOneDCacheSize, ProcessorName, NodeName, UpTime, Priority, MaxFD,
+		MemFree, voluntary_ctxt_switches, minor_faults, PerfCycles, 
+		NumaLocalMemory, CpuUserTime, SmapsPss, rchar, PressureCpuSomeAvg10,
+		CgroupPressureCpuSomeAvg10, CgroupCpu_throttled_usec
+	};
+	const int pid = getpid();
+	volatile size_t sink = 0;
+	char buf[256];
+
+	for (size_t i(0); i < sizeof(traits) / sizeof(traits[0]); i++) {
+		const Trait t = traits[i];
+		const size_t ops = trait_volatility(t) == StaticBoot ? iterations : iterations / 100;
+
+		measure("source", SystemInfo::getName(t), 1, ops, 10, [&]() {
+			sink += SystemInfo::getSystemProperty(t, pid).size();
+		});
+	}
+
+	/** the per-mapping alternative to smaps_rollup **/
+	measure("source", "smaps_per_mapping", 1, iterations / 100, 1, [&]() {
+		proc_smaps_for_each(pid, buf, sizeof(buf), [&](const struct SmapsMapping &map) {
+			sink += map.fields[0];
+			return true;
+		});
+	});
+
+	/** what every ProcessorName query cost before the static cache **/
+	measure("source", "ProcessorName_uncached", 1, iterations / 1000, 1, [&]() {
+		parse_named_value("/proc/cpuinfo", "model name", buf);
+		sink += buf[0];
+	});
+}
+
+/**
+ * bench_snapshots - one pid through a cold snapshot, a warm
+ * SystemContext and a warm context limited by a TraitSet.
+ */
+static void bench_snapshots (const size_t iterations)
+{
+	static const TraitSet wanted{ resident_mem_size, voluntary_ctxt_switches };
+	const int pid = getpid();
+	struct SystemSnapshot snap;
+	std::vector< TraitValue > values;
+	SystemContext all, few;
+	volatile uint64_t sink = 0;
+
+	all.open(pid);
+	few.open(pid, wanted);
+
+	measure("snapshot", "snapshot_cold", 1, iterations, 1, [&]() {
+		SystemInfo::snapshot(&snap, pid);
+		sink += snap.stat.minor_faults;
+	});
+	measure("snapshot", "context_warm", 1, iterations, 1, [&]() {
+		all.sample();
+		sink += all.getSnapshot().stat.minor_faults;
+	});
+	measure("snapshot", "context_warm_2_traits", 1, iterations, 1, [&]() {
+		few.sample();
+		sink += few.getSnapshot().stat.minor_faults;
+	});
+	measure("snapshot", "query_2_traits", 1, iterations, 1, [&]() {
+		SystemInfo::query(wanted, &pid, 1, values);
+		sink += values[0].u;
+	});
+
+	/** an exited pid must not come back as a row of zeroes **/
+	static const TraitSet per_pid{ SmapsRss, rchar, NumaLocalMemory, MemFree };
+	const int child = fork();
+	size_t read = 0, none = 0;
+
+	if (child == 0)
+		_exit(0);
+	waitpid(child, NULL, 0);
+	read = SystemInfo::query(per_pid, &child, 1, values);
+	for (size_t v(0); v < values.size(); v++)
+		none += values[v].type == TypeNone;
+	printf("{\"group\":\"check\",\"name\":\"query_exited_pid\","
+	       "\"read\":%zu,\"none\":%zu,\"ok\":%s}\n",
+	       read, none, read == 0 && none == values.size() ? "true" : "false");
+}
+
+/**
+ * bench_pids - a pass over n pids with one warm context each,
+ * reading stat and status, the usual per-process collection.
+ */
+static void bench_pids (const size_t n, const size_t iterations)
+{
+	static const TraitSet wanted{ minor_faults, resident_mem_size, 
+	                              voluntary_ctxt_switches };
+	const std::vector< int > pids = host_pids(n);
+	std::vector< SystemContext > contexts(pids.size());
+	struct rlimit limit;
+	volatile uint64_t sink = 0;
+	size_t opened = 0;
+
+	/** two fds per pid, leave room for everything else **/
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+	for (size_t i(0); i < pids.size(); i++)
+		opened += contexts[i].open(pids[i], wanted) == 0;
+	if (opened < pids.size()) {
+		fprintf(stderr, "bench_pids: opened %zu of %zu pids\n", opened, pids.size());
+	}
+
+	measure("pids", "context_pass", n, iterations, 1, [&]() {
+		for (size_t i(0); i < contexts.size(); i++) {
+			contexts[i].sample();
+			sink += contexts[i].getSnapshot().stat.minor_faults;
+		}
+	});
+}
+
+static void bench_process_table (const size_t iterations)
+{
+	ProcessTable serial, parallel;
+	CollectorPool pool;
+
+	parallel.setPool(&pool);
+	serial.refresh();
+	measure("table", "process_table_serial", serial.size(), iterations, 1, [&]() {
+		serial.refresh();
+	});
+	parallel.refresh();
+	measure("table", "process_table_pool_" + std::to_string(pool.workers()), 
+	        parallel.size(), iterations, 1, [&]() {
+		parallel.refresh();
+	});
+}
+
+/**
+ * bench_uring - 1000 stat reads per pass through pread and
+ * through ProcUring.
+ */
+static void bench_uring (const size_t iterations)
+{
+	const std::vector< int > pids = host_pids(1000);
+	ProcUring ring;
+	std::vector< int > fds;
+	struct ProcStatData data;
+	char buf[PROC_BUFFER_SIZE], path[64];
+	volatile uint64_t sink = 0;
+
+	for (size_t i(0); i < pids.size(); i++) {
+		snprintf(path, sizeof(path), "/proc/%d/stat", pids[i]);
+		fds.push_back(open(path, O_RDONLY | O_CLOEXEC));
+	}
+	const bool have_ring = (ring.open(2048) == 0);
+
+	measure("uring", "pread", fds.size(), iterations, 1, [&]() {
+		for (size_t i(0); i < fds.size(); i++) {
+			const ssize_t len = proc_read_fd(fds[i], buf, sizeof(buf));
+
+			if (len > 0 && proc_stat_parse(buf, len, &data) == 0)
+				sink += data.minor_faults;
+		}
+	});
+	measure("uring", have_ring ? "io_uring" : "io_uring_fallback", fds.size(), 
+	        iterations, 1, [&]() {
+		ring.read(fds.data(), fds.size(), [&](size_t, char *slot, ssize_t len) {
+			if (len > 0 && proc_stat_parse(slot, len, &data) == 0)
+				sink += data.minor_faults;
+		});
+	});
+
+	for (size_t i(0); i < fds.size(); i++)
+		close(fds[i]);
+}
+
+/**
+ * Output is one JSON object per line: group, name, pids sampled
+ * per op, ops measured, mean/p50/p99 ns per op, syscalls and
+ * allocations per op.  The optional argument scales the number of
+ * iterations of every benchmark.
+ */
+int main (int argc, char **argv)
+{
+	size_t iterations = 1000000;
+
+	if (argc == 2)
+		iterations = strtoul(argv[1], NULL, 10);
+
+	bench_stat_parse(iterations);
+	bench_meminfo_parse(iterations / 10);
+	bench_sources(iterations / 10);
+	bench_snapshots(iterations / 1000 + 1);
+	bench_pids(1, iterations / 1000 + 1);
+	bench_pids(100, iterations / 10000 + 1);
+	bench_pids(5000, iterations / 100000 + 1);
+	bench_process_table(iterations / 10000 + 1);
+	bench_uring(iterations / 10000 + 1);
+	return 0;
+}
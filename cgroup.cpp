@@ -0,0 +1,170 @@
+/**
+ * cgroup.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <string>
+#include <mutex>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "cgroup.hpp"
+#include "procparse.hpp"
+
+const char *cgroup2_mount ()
+{
+	static std::once_flag once;
+	static std::string mount;
+
+	std::call_once(once, []() {
+		char buf[PROC_BUFFER_SIZE];
+
+		/** "36 25 0:30 / /sys/fs/cgroup rw,... shared:9 - cgroup2 cgroup2 rw" **/
+		for_each_line("/proc/self/mountinfo", buf, sizeof(buf), 
+		              [&](const char *line, size_t) {
+			const char *dash = strstr(line, " - ");
+			const char *point = line;
+
+			if (!dash || strncmp(dash + 3, "cgroup2 ", 8))
+				return true;
+			for (int field(0); field < 4 && point; field++) {
+				if ((point = strchr(point, ' ')) != NULL)
+					point++;
+			}
+			if (point && point < dash)
+				mount.assign(point, strcspn(point, " "));
+			return mount.empty();
+		});
+	});
+
+	return mount.empty() ? NULL : mount.c_str();
+}
+
+int cgroup_dir (const int pid, char *buf, const size_t size)
+{
+	const char *mount = cgroup2_mount();
+	char path[64], line_buf[PROC_BUFFER_SIZE];
+	int ret = -1;
+
+	if (!mount)
+		return -1;
+
+	snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+	if (for_each_line(path, line_buf, sizeof(line_buf), [&](const char *line, size_t) {
+		if (strncmp(line, "0::", 3))
+			return true;
+		/** the root cgroup is "/", keep the mount point without a trailing slash **/
+		if ((size_t)snprintf(buf, size, "%s%s", mount, 
+		                     strcmp(line + 3, "/") ? line + 3 : "") < size)
+			ret = 0;
+		return false;
+	}) < 0)
+		return -1;
+
+	return ret;
+}
+
+/** in the order cgroup_read expects them **/
+static const char *cgroup_files[CGROUP_FILES] = {
+	"memory.current", "memory.max", "memory.stat", "cpu.stat", "cpu.max", "io.stat"
+};
+
+int cgroup_open (const char *dir, int fds[CGROUP_FILES])
+{
+	char path[PATH_MAX];
+	int opened = 0;
+
+	for (int f(0); f < CGROUP_FILES; f++) {
+		fds[f] = -1;
+		if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, cgroup_files[f]) >= sizeof(path))
+			continue;
+		if ((fds[f] = open(path, O_RDONLY | O_CLOEXEC)) >= 0)
+			opened++;
+	}
+	return opened;
+}
+
+/**
+ * limit_value - a limit file's number, -1 for "max".
+ */
+static int64_t limit_value (const char *val, char **end)
+{
+	if (!strncmp(val, "max", 3)) {
+		*end = (char *)val + 3;
+		return -1;
+	}
+	return (int64_t)strtoull(val, end, 10);
+}
+
+int cgroup_read (const int fds[CGROUP_FILES], char *buf, const size_t size,
+                 struct CgroupSample *sample)
+{
+	int ret = -1;
+	char *end;
+
+	memset(sample, 0, sizeof(struct CgroupSample));
+	sample->memory_max = sample->cpu_quota = -1;
+
+	for (int f(0); f < CGROUP_FILES; f++) {
+		ssize_t len;
+
+		if (fds[f] < 0 || (len = proc_read_fd(fds[f], buf, size)) < 0)
+			continue;
+		ret = 0;
+		switch (f) {
+			case 0:
+				sample->memory_current = strtoull(buf, NULL, 10);
+				break;
+			case 1:
+				sample->memory_max = limit_value(buf, &end);
+				break;
+			case 2:
+				proc_cgroup_memory_parse(buf, len, sample->memory);
+				break;
+			case 3:
+				proc_cgroup_cpu_parse(buf, len, sample->cpu);
+				break;
+			case 4:
+				/** "$MAX $PERIOD" **/
+				sample->cpu_quota = limit_value(buf, &end);
+				sample->cpu_period = strtoull(end, NULL, 10);
+				break;
+			case 5:
+				proc_cgroup_io_parse(buf, len, sample->io);
+				break;
+		}
+	}
+	return ret;
+}
+
+int cgroup_read_dir (const char *dir, char *buf, const size_t size, 
+                     struct CgroupSample *sample)
+{
+	int fds[CGROUP_FILES], ret;
+
+	cgroup_open(dir, fds);
+	ret = cgroup_read(fds, buf, size, sample);
+	for (int f(0); f < CGROUP_FILES; f++) {
+		if (fds[f] >= 0)
+			close(fds[f]);
+	}
+	return ret;
+}
@@ -0,0 +1,68 @@
+/**
+ * cgroup.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _CGROUP_HPP_
+#define _CGROUP_HPP_  1
+#include <cstddef>
+
+#include "systeminfo.hpp"
+
+/** the accounting files of a cgroup a CgroupSample is read from **/
+#define CGROUP_FILES 6
+
+/**
+ * cgroup2_mount - where the unified (v2) hierarchy is mounted,
+ * /sys/fs/cgroup on pure v2 hosts and /sys/fs/cgroup/unified on
+ * hybrid ones.  Looked up in mountinfo once.
+ * @return  const char * - the mount point, NULL if there is none
+ */
+const char *cgroup2_mount ();
+
+/**
+ * cgroup_dir - directory of pid's v2 cgroup, the "0::" line of
+ * /proc/<pid>/cgroup under the v2 mount.
+ * @return  int - 0 on success, -1 if pid or the v2 mount is gone
+ */
+int cgroup_dir (const int pid, char *buf, const size_t size);
+
+/**
+ * cgroup_open - open memory.current, memory.max, memory.stat,
+ * cpu.stat, cpu.max and io.stat of the cgroup at dir.  Files of
+ * controllers that aren't enabled there don't exist and get -1.
+ * @return  int - number of files opened
+ */
+int cgroup_open (const char *dir, int fds[CGROUP_FILES]);
+
+/**
+ * cgroup_read - pread every open fd through buf into sample;
+ * fields of a closed or unreadable fd are zeroed, limits -1.
+ * @return  int - 0 if any file was read, -1 otherwise
+ */
+int cgroup_read (const int fds[CGROUP_FILES], char *buf, const size_t size,
+                 struct CgroupSample *sample);
+
+/**
+ * cgroup_read_dir - one-shot cgroup_open, cgroup_read and close
+ * of dir.
+ * @return  int - 0 if any file was read, -1 otherwise
+ */
+int cgroup_read_dir (const char *dir, char *buf, const size_t size, 
+                     struct CgroupSample *sample);
+
+#endif /* END _CGROUP_HPP_ */
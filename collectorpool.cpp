@@ -0,0 +1,168 @@
+/**
+ * collectorpool.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/sysinfo.h>
+
+#include "collectorpool.hpp"
+#include "procparse.hpp"
+
+CollectorPool::CollectorPool( const size_t threads,
+                              const std::vector< int > &cpus ) : shards( NULL ),
+                                                                 job( NULL ),
+                                                                 generation( 0 ),
+                                                                 running( 0 ),
+                                                                 stopping( false )
+{
+	size_t n = threads ? threads : (size_t)get_nprocs();
+	void *ptr = NULL;
+
+	if (n == 0)
+		n = 1;
+	/** one cache line per shard, thieves and owner hammer the cursor **/
+	if (posix_memalign(&ptr, PROC_BUFFER_ALIGN, n * sizeof(Shard)) != 0)
+		throw std::bad_alloc();
+	shards = (Shard *)ptr;
+	for (size_t w(0); w < n; w++) {
+		new (&shards[w].next) std::atomic< size_t >(0);
+		shards[w].end = 0;
+	}
+
+	for (size_t w(0); w < n; w++)
+		this->threads.push_back(std::thread(&CollectorPool::work, this, w));
+	if (!cpus.empty())
+		setAffinity(cpus);
+}
+
+CollectorPool::~CollectorPool()
+{
+	{
+		std::lock_guard< std::mutex > guard(lock);
+
+		stopping = true;
+	}
+	start.notify_all();
+	for (size_t w(0); w < threads.size(); w++)
+		threads[w].join();
+	free(shards);
+}
+
+int
+CollectorPool::setAffinity (const std::vector< int > &cpus)
+{
+	cpu_set_t set;
+	int ret = 0;
+
+	CPU_ZERO(&set);
+	if (cpus.empty()) {
+		for (int c(0); c < CPU_SETSIZE; c++)
+			CPU_SET(c, &set);
+	}
+	for (size_t i(0); i < cpus.size(); i++) {
+		if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE)
+			CPU_SET(cpus[i], &set);
+	}
+
+	for (size_t w(0); w < threads.size(); w++) {
+		if (pthread_setaffinity_np(threads[w].native_handle(), 
+		                           sizeof(set), &set) != 0)
+			ret = -1;
+	}
+	return ret;
+}
+
+bool
+CollectorPool::claim (const size_t worker, size_t *begin, size_t *end)
+{
+	const size_t n = threads.size();
+
+	/** own shard first, then walk the others starting next door **/
+	for (size_t i(0); i < n; i++) {
+		Shard &s = shards[(worker + i) % n];
+
+		if (s.next.load(std::memory_order_relaxed) >= s.end)
+			continue;
+		*begin = s.next.fetch_add(COLLECTOR_CHUNK, std::memory_order_relaxed);
+		if (*begin < s.end) {
+			*end = *begin + COLLECTOR_CHUNK < s.end ? *begin + COLLECTOR_CHUNK : s.end;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+CollectorPool::work (const size_t worker)
+{
+	unsigned long seen = 0;
+
+	for (;;) {
+		const std::function< void (size_t, size_t) > *fn;
+		size_t begin, end;
+
+		{
+			std::unique_lock< std::mutex > guard(lock);
+
+			start.wait(guard, [&]() { return stopping || generation != seen; });
+			if (stopping)
+				return;
+			seen = generation;
+			fn = job;
+		}
+
+		while (claim(worker, &begin, &end)) {
+			for (size_t i(begin); i < end; i++)
+				(*fn)(worker, i);
+		}
+
+		{
+			std::lock_guard< std::mutex > guard(lock);
+
+			if (--running == 0)
+				done.notify_one();
+		}
+	}
+}
+
+void
+CollectorPool::run (const size_t count, const std::function< void (size_t, size_t) > &fn)
+{
+	const size_t n = threads.size();
+
+	if (count == 0)
+		return;
+
+	for (size_t w(0); w < n; w++) {
+		shards[w].next.store(count * w / n, std::memory_order_relaxed);
+		shards[w].end = count * (w + 1) / n;
+	}
+
+	std::unique_lock< std::mutex > guard(lock);
+
+	job = &fn;
+	running = n;
+	generation++;
+	start.notify_all();
+	done.wait(guard, [&]() { return running == 0; });
+	job = NULL;
+}
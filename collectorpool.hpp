@@ -0,0 +1,96 @@
+/**
+ * collectorpool.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _COLLECTORPOOL_HPP_
+#define _COLLECTORPOOL_HPP_  1
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** indices a worker claims at a time, enough to amortize the atomic **/
+#define COLLECTOR_CHUNK 32
+
+/**
+ * CollectorPool - a fixed set of worker threads for sweeping many
+ * pids per interval.  run() splits [0, count) into one contiguous
+ * shard per worker; a worker claims COLLECTOR_CHUNK indices at a
+ * time from its own shard and, once that is empty, steals chunks
+ * from the other shards, so a worker stuck on slow pids doesn't
+ * hold up the pass.  Claims are a single fetch_add on the shard's
+ * cursor, no lock is taken per item.  Each worker has a stable
+ * index in [0, workers()) for per-worker buffers.  The threads
+ * can be pinned to a cpu list so collection stays off the cores
+ * being measured.
+ */
+class CollectorPool
+{
+public:
+   /**
+    * @param threads - worker count, 0 for one per online cpu
+    * @param cpus - cpus to pin the workers to, empty for no pinning
+    * @throws std::bad_alloc if the shards can't be allocated
+    */
+   CollectorPool( const size_t threads = 0,
+                  const std::vector< int > &cpus = std::vector< int >() );
+   ~CollectorPool();
+
+   CollectorPool( const CollectorPool &other )              = delete;
+   CollectorPool &operator = ( const CollectorPool &other ) = delete;
+
+   size_t workers () const { return threads.size(); }
+
+   /**
+    * setAffinity - pin every worker to cpus, empty to unpin.
+    * @return  int - 0 on success, -1 if any worker couldn't be pinned
+    */
+   int setAffinity (const std::vector< int > &cpus);
+
+   /**
+    * run - call fn(worker, index) once for every index in
+    * [0, count) across the workers and return when all are done.
+    * Not reentrant: one run() at a time per pool.
+    */
+   void run (const size_t count, const std::function< void (size_t, size_t) > &fn);
+
+private:
+   struct Shard {
+      std::atomic< size_t > next;
+      size_t                end;
+      char                  pad[64 - sizeof(std::atomic< size_t >) - sizeof(size_t)];
+   };
+
+   void work (const size_t worker);
+   bool claim (const size_t worker, size_t *begin, size_t *end);
+
+   std::vector< std::thread > threads;
+   Shard                     *shards;
+   const std::function< void (size_t, size_t) > *job;
+   std::mutex                 lock;
+   std::condition_variable    start;
+   std::condition_variable    done;
+   unsigned long              generation;
+   size_t                     running;
+   bool                       stopping;
+};
+
+#endif /* END _COLLECTORPOOL_HPP_ */
@@ -0,0 +1,213 @@
+/**
+ * cpustat.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "cpustat.hpp"
+#include "procparse.hpp"
+
+#define SYSFS_CPU "/sys/devices/system/cpu"
+
+static const char *freq_files[3] = {
+	"scaling_cur_freq",
+	"scaling_min_freq",
+	"scaling_max_freq"
+};
+
+/**
+ * parse_cpu_line - fill sample from a "cpuN ..." line; older
+ * kernels stop before steal, those columns stay 0.
+ * @return  int - cpu number, -1 for the host line, -2 if not a cpu line
+ */
+static int parse_cpu_line (const char *line, struct CpuSample *sample)
+{
+	char *end;
+	int cpu = -1;
+
+	if (strncmp(line, "cpu", 3) != 0)
+		return -2;
+	line += 3;
+	if (*line != ' ') {
+		cpu = (int)strtol(line, &end, 10);
+		if (end == line)
+			return -2;
+		line = end;
+	}
+
+	memset(sample, 0, sizeof(struct CpuSample));
+	sample->cpu = cpu;
+	for (int f(0); f < CPU_STAT_FIELDS; f++) {
+		sample->time[f] = strtoull(line, &end, 10);
+		if (end == line)
+			break;
+		line = end;
+	}
+	return cpu;
+}
+
+static uint64_t read_freq (const int fd)
+{
+	char buf[32];
+
+	if (fd < 0 || proc_read_fd(fd, buf, sizeof(buf)) < 0)
+		return 0;
+	return strtoull(buf, NULL, 10);
+}
+
+int cpu_sample_read (const int cpu, struct CpuSample *sample)
+{
+	char buf[PROC_BUFFER_SIZE];
+	bool found = false;
+
+	/** the cpu lines come first, stop at the first line that isn't one **/
+	if (for_each_line("/proc/stat", buf, sizeof(buf), [&](const char *line, size_t) {
+		const int id = parse_cpu_line(line, sample);
+
+		if (id == -2)
+			return false;
+		found = (id == cpu);
+		return !found;
+	}) < 0 || !found)
+		return -1;
+
+	if (cpu >= 0) {
+		char path[128];
+		uint64_t *freq[3] = { &sample->freq_cur, &sample->freq_min, &sample->freq_max };
+
+		for (int i(0); i < 3; i++) {
+			int fd;
+
+			snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cpufreq/%s", 
+			         cpu, freq_files[i]);
+			if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+				break;
+			*freq[i] = read_freq(fd);
+			close(fd);
+		}
+	}
+	return 0;
+}
+
+CpuSampler::CpuSampler()
+{
+}
+
+CpuSampler::~CpuSampler()
+{
+	for (size_t i(0); i < freq_fd.size(); i++) {
+		if (freq_fd[i] >= 0)
+			close(freq_fd[i]);
+	}
+}
+
+int
+CpuSampler::openFreq (const int cpu)
+{
+	char path[128];
+
+	/** cpu ids can be sparse, -2 marks an id that was never tried **/
+	if ((size_t)cpu * 3 >= freq_fd.size())
+		freq_fd.resize((cpu + 1) * 3, -2);
+	for (int i(0); i < 3; i++) {
+		snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cpufreq/%s", 
+		         cpu, freq_files[i]);
+		freq_fd[cpu * 3 + i] = open(path, O_RDONLY | O_CLOEXEC);
+	}
+	return freq_fd[cpu * 3] < 0 ? -1 : 0;
+}
+
+void
+CpuSampler::readFreq (struct CpuSample *sample)
+{
+	const int cpu = sample->cpu;
+
+	if ((size_t)cpu * 3 >= freq_fd.size() || freq_fd[cpu * 3] == -2)
+		openFreq(cpu);
+	sample->freq_cur = read_freq(freq_fd[cpu * 3]);
+	sample->freq_min = read_freq(freq_fd[cpu * 3 + 1]);
+	sample->freq_max = read_freq(freq_fd[cpu * 3 + 2]);
+}
+
+int
+CpuSampler::sample ()
+{
+	char buf[PROC_BUFFER_SIZE];
+	struct CpuSample sample;
+
+	prev.swap(curr);
+	curr.clear();
+
+	if (for_each_line("/proc/stat", buf, sizeof(buf), [&](const char *line, size_t) {
+		const int id = parse_cpu_line(line, &sample);
+
+		if (id == -2)
+			return false;
+		if (id >= 0)
+			curr.push_back(sample);
+		return true;
+	}) < 0)
+		return -1;
+
+	for (size_t i(0); i < curr.size(); i++)
+		readFreq(&curr[i]);
+	return 0;
+}
+
+int
+CpuSampler::usage (std::vector< CpuUsage > &out) const
+{
+	size_t p = 0;
+
+	out.clear();
+	if (prev.empty() || curr.empty())
+		return -1;
+
+	for (size_t i(0); i < curr.size(); i++) {
+		const CpuSample &c = curr[i];
+		CpuUsage u;
+		uint64_t delta[CPU_STAT_FIELDS], total = 0;
+
+		/** both passes are in cpu order, walk them together **/
+		while (p < prev.size() && prev[p].cpu < c.cpu)
+			p++;
+		if (p == prev.size() || prev[p].cpu != c.cpu)
+			continue;
+
+		for (int f(0); f < CPU_STAT_FIELDS; f++) {
+			/** iowait may go backwards on an idle cpu, clamp it **/
+			delta[f] = c.time[f] >= prev[p].time[f] ? c.time[f] - prev[p].time[f] : 0;
+			total += delta[f];
+		}
+
+		u.cpu = c.cpu;
+		u.freq_cur = c.freq_cur;
+		u.freq_max = c.freq_max;
+		for (int f(0); f < CPU_STAT_FIELDS; f++)
+			u.percent[f] = total ? 100.0 * delta[f] / total : 0.0;
+		u.busy = 100.0 - u.percent[CpuIdle] - u.percent[CpuIOWait];
+		if (!total)
+			u.busy = 0.0;
+		out.push_back(u);
+	}
+	return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * cpustat.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _CPUSTAT_HPP_
+#define _CPUSTAT_HPP_  1
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "systeminfo.hpp"
+
+/**
+ * cpu_sample_read - jiffies and cpufreq of a single cpu, or of
+ * the host wide "cpu" line when cpu is -1.
+ * @return  int - 0 on success, -1 if the cpu isn't in /proc/stat
+ */
+int cpu_sample_read (const int cpu, struct CpuSample *sample);
+
+/**
+ * CpuUsage - share of one cpu's time in each CpuStatField between
+ * two samples, in percent of the interval, plus the frequency the
+ * second sample saw.  busy is everything but idle and iowait.
+ */
+struct CpuUsage{
+   int      cpu;
+   double   percent[CPU_STAT_FIELDS];
+   double   busy;
+   uint64_t freq_cur;  /* kHz */
+   uint64_t freq_max;  /* kHz, 0 without cpufreq */
+};
+
+/**
+ * CpuSampler - samples every online cpu per pass into one
+ * contiguous array, ordered as /proc/stat lists them, and keeps
+ * the previous pass for deltas.  The cpufreq files of each cpu are
+ * kept open and refreshed with pread, so a pass costs one read of
+ * /proc/stat plus three preads per cpu with cpufreq.
+ */
+class CpuSampler
+{
+public:
+   CpuSampler();
+   ~CpuSampler();
+
+   CpuSampler( const CpuSampler &other )              = delete;
+   CpuSampler &operator = ( const CpuSampler &other ) = delete;
+
+   /**
+    * sample - take a new pass, the current one becomes the previous.
+    * @return  int - 0 on success, -1 if /proc/stat can't be read
+    */
+   int sample ();
+
+   /** samples of the last pass, contiguous **/
+   const CpuSample *samples () const { return curr.data(); }
+   size_t size () const { return curr.size(); }
+
+   /**
+    * usage - per cpu usage between the last two passes.  A cpu
+    * that was hotplugged in between has no baseline and is left out.
+    * @return  int - 0 on success, -1 before the second pass
+    */
+   int usage (std::vector< CpuUsage > &out) const;
+
+private:
+   int openFreq (const int cpu);
+   void readFreq (struct CpuSample *sample);
+
+   std::vector< CpuSample > prev;
+   std::vector< CpuSample > curr;
+   /** three fds (cur, min, max) per cpu id, -1 when absent **/
+   std::vector< int >       freq_fd;
+};
+
+#endif /* END _CPUSTAT_HPP_ */
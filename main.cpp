@@ -1,22 +1,401 @@
 #include "systeminfo.hpp"
+#include "systemcontext.hpp"
+#include "recordformat.hpp"
+#include "shmring.hpp"
+#include "procparse.hpp"
+#include "pressure.hpp"
+#include "cgroup.hpp"
 #include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cinttypes>
+#include <climits>
 #include <unistd.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+
+static void usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [--interval MS [--count N]] [--binary FILE [--delta]] "
+	                "[--shm NAME] [--psi RESOURCE:STALL_MS] [--perf] [pid]\n"
+	                "       %s --read FILE\n"
+	                "       %s --attach NAME\n"
+	                "       %s --smaps [pid]\n", name, name, name, name);
+}
+
+static void print_traits (const SystemContext &ctx)
+{
+	for (int t(0); t < (int)Trait::N; t++) {
+		std::cout << SystemInfo::getName((Trait)t) << " - " <<
+			     ctx.getProperty((Trait)t) << "\n";
+	}
+}
+
+/**
+ * run_daemon - sample pid every interval_ms on absolute deadlines
+ * of a CLOCK_MONOTONIC timerfd, so time spent collecting and
+ * printing never pushes the schedule back.  The context keeps its
+ * fds and buffers between samples.  Each sample is preceded by a
+ * line with its collection latency, the number of deadlines
+ * missed since the previous one and, from the second sample on,
+ * the cpu, I/O and cgroup rates and the usage of every online cpu
+ * since the previous one.  count 0 runs until the pid exits.  With
+ * a writer the samples are appended as binary records, with a ring
+ * they are published to shared memory, instead of printed.  With a
+ * trigger a PSI event takes a sample at once, off the schedule,
+ * marked trigger=1.  The Perf* traits are only sampled when traits
+ * asks for them (--perf).
+ */
+static int run_daemon (const int pid, const long interval_ms, const unsigned long count,
+                       RecordWriter *writer, ShmRing *ring, PressureTrigger *trigger,
+                       const TraitSet &traits)
+{
+	struct pollfd fds[2];
+	SystemContext ctx;
+	struct itimerspec spec;
+	uint64_t expirations, min_ns = UINT64_MAX, max_ns = 0, total_ns = 0;
+	std::vector< CpuUsage > usage;
+	unsigned long n = 0;
+	int tfd;
+
+	if (ctx.open(pid, traits) < 0) {
+		fprintf(stderr, "Failed to open /proc data for pid %d\n", pid);
+		return 1;
+	}
+
+	if ((tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) < 0) {
+		perror("timerfd_create");
+		return 1;
+	}
+
+	memset(&spec, 0, sizeof(spec));
+	clock_gettime(CLOCK_MONOTONIC, &spec.it_value);
+	spec.it_interval.tv_sec = interval_ms / 1000;
+	spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+	if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+		perror("timerfd_settime");
+		close(tfd);
+		return 1;
+	}
+
+	fds[0].fd = tfd;
+	fds[0].events = POLLIN;
+	fds[1].fd = trigger ? trigger->getFd() : -1;
+	fds[1].events = POLLPRI;
+
+	while (count == 0 || n < count) {
+		uint64_t start, latency;
+		bool triggered = false;
+
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("poll");
+			break;
+		}
+		if (fds[1].revents & (POLLERR | POLLNVAL)) {
+			fprintf(stderr, "PSI trigger is gone, sampling on schedule only\n");
+			fds[1].fd = -1;
+		}
+		else if (fds[1].revents & POLLPRI)
+			triggered = true;
+
+		expirations = 0;
+		if ((fds[0].revents & POLLIN) && 
+		    read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations) &&
+		    errno != EINTR && errno != EAGAIN) {
+			perror("timerfd read");
+			break;
+		}
+		if (!expirations && !triggered)
+			continue;
+
+		start = monotonic_ns();
+		if (ctx.sample() < 0) {
+			fprintf(stderr, "pid %d is gone\n", pid);
+			break;
+		}
+		latency = monotonic_ns() - start;
+
+		min_ns = latency < min_ns ? latency : min_ns;
+		max_ns = latency > max_ns ? latency : max_ns;
+		total_ns += latency;
+		n++;
+
+		if (ring) {
+			const struct SystemSnapshot &snap = ctx.getSnapshot();
+			struct ShmSample sample;
+
+			sample.timestamp = snap.timestamp;
+			sample.pid = snap.pid;
+			sample.stat = snap.stat;
+			sample.status = snap.status;
+			memcpy(sample.meminfo, snap.meminfo, sizeof(sample.meminfo));
+			ring->publish(&sample);
+		}
+		if (writer && writer->write(&ctx.getSnapshot()) < 0) {
+			perror("Failed to write record");
+			break;
+		}
+		if (ring || writer)
+			continue;
+
+		printf("sample=%lu timestamp=%" PRIu64 " latency_ns=%" PRIu64 " missed=%" PRIu64,
+		       n, ctx.getSnapshot().timestamp, latency, expirations ? expirations - 1 : 0);
+		if (triggered)
+			printf(" trigger=1");
+		if (ctx.getRates().valid) {
+			const struct ProcRates &rates = ctx.getRates();
+
+			printf(" cpu_percent=%.1f rchar_per_sec=%.0f wchar_per_sec=%.0f "
+			       "read_bytes_per_sec=%.0f write_bytes_per_sec=%.0f "
+			       "cgroup_cpu_percent=%.1f cgroup_throttled_percent=%.1f",
+			       rates.cpu_percent, rates.rchar, rates.wchar, 
+			       rates.read_bytes, rates.write_bytes,
+			       rates.cgroup_cpu_percent, rates.cgroup_throttled_percent);
+		}
+		if (ctx.getCpuUsage(usage) == 0) {
+			for (size_t c(0); c < usage.size(); c++)
+				printf(" cpu%d_busy_percent=%.1f cpu%d_freq_khz=%" PRIu64, 
+				       usage[c].cpu, usage[c].busy, usage[c].cpu, usage[c].freq_cur);
+		}
+		printf("\n");
+		fflush(stdout);
+		print_traits(ctx);
+		std::cout.flush();
+	}
+
+	close(tfd);
+	if (n > 0) {
+		fprintf(stderr, "%lu samples, latency min %" PRIu64 " avg %" PRIu64
+		        " max %" PRIu64 " ns\n", n, min_ns, total_ns / n, max_ns);
+	}
+	return n > 0 ? 0 : 1;
+}
+
+/**
+ * read_records - print a record file in the text format.
+ */
+static int read_records (const char *path)
+{
+	RecordReader reader;
+	struct RecordSample sample;
+
+	if (reader.open(path) < 0) {
+		fprintf(stderr, "%s is not a readable record file\n", path);
+		return 1;
+	}
+
+	while (reader.next(&sample)) {
+		printf("pid=%d timestamp=%" PRIu64 "\n", sample.pid, sample.timestamp);
+		for (size_t f(0); f < reader.fields().size(); f++) {
+			std::cout << reader.fields()[f].name << " - " <<
+				     SystemInfo::valueToString(reader.value(&sample, f)) << "\n";
+		}
+	}
+	return 0;
+}
+
+/**
+ * attach_ring - print the newest sample a collector published.
+ */
+static int attach_ring (const char *name)
+{
+	ShmRing ring;
+	struct ShmSample sample;
+	struct SystemSnapshot snap;
+
+	if (ring.attach(name) < 0) {
+		fprintf(stderr, "No samples published in %s\n", name);
+		return 1;
+	}
+	errno = 0;
+	if (ring.latest(&sample) < 0) {
+		if (errno == EAGAIN)
+			fprintf(stderr, "Collector is stuck writing %s\n", name);
+		else
+			fprintf(stderr, "No samples published in %s\n", name);
+		return 1;
+	}
+
+	memset(&snap, 0, sizeof(snap));
+	snap.pid = sample.pid;
+	snap.timestamp = sample.timestamp;
+	snap.stat = sample.stat;
+	snap.status = sample.status;
+	memcpy(snap.meminfo, sample.meminfo, sizeof(snap.meminfo));
+
+	printf("pid=%d sample=%" PRIu64 " timestamp=%" PRIu64 "\n", 
+	       sample.pid, sample.index, sample.timestamp);
+	for (int t(MemTotal); t <= child_guest_time; t++) {
+		std::cout << SystemInfo::getName((Trait)t) << " - " <<
+			     SystemInfo::getSnapshotProperty((Trait)t, &snap) << "\n";
+	}
+	return 0;
+}
+
+/**
+ * print_smaps - one line per mapping of pid with the fields that
+ * say where its memory goes, in kB, streamed from smaps.
+ */
+static int print_smaps (const int pid)
+{
+	static const Trait columns[] = {
+		SmapsRss, SmapsPss, SmapsAnonymous, SmapsPrivate_Dirty, SmapsSwap, 
+		SmapsSwapPss, SmapsAnonHugePages
+	};
+	char buf[PROC_BUFFER_SIZE];
+	bool header = false;
+
+	if (proc_smaps_for_each(pid, buf, sizeof(buf), [&](const struct SmapsMapping &map) {
+		if (!header) {
+			printf("%-33s %-4s", "mapping", "perm");
+			for (const Trait t : columns)
+				printf(" %13s", SystemInfo::getName(t) + strlen("Smaps"));
+			printf(" path\n");
+			header = true;
+		}
+		printf("%016" PRIx64 "-%016" PRIx64 " %-4s", map.start, map.end, map.perms);
+		for (const Trait t : columns)
+			printf(" %13" PRIu64, map.fields[t - SmapsRss]);
+		printf(" %s\n", map.path);
+		return true;
+	}) < 0) {
+		fprintf(stderr, "Failed to read smaps of pid %d\n", pid);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * open_trigger - arm a trigger for "RESOURCE:STALL_MS", a some
+ * stall of STALL_MS within PRESSURE_WINDOW_US on cpu, memory or
+ * io.  The pid's cgroup is watched when there is one, otherwise
+ * the host.
+ */
+static int open_trigger (PressureTrigger *trigger, const int pid, const char *spec)
+{
+	const char *colon = strchr(spec, ':');
+	char dir[PATH_MAX];
+	unsigned long stall_ms;
+
+	if (!colon || (stall_ms = strtoul(colon + 1, NULL, 10)) == 0 || 
+	    stall_ms * 1000 > PRESSURE_WINDOW_US) {
+		fprintf(stderr, "--psi wants RESOURCE:STALL_MS with STALL_MS up to %d\n", 
+		        PRESSURE_WINDOW_US / 1000);
+		return -1;
+	}
+	if (cgroup_dir(pid, dir, sizeof(dir)) < 0)
+		strcpy(dir, PRESSURE_HOST_DIR);
+
+	for (int r(0); r < PRESSURE_RESOURCES; r++) {
+		const char *name = pressure_name((PressureResource)r);
+
+		if (strlen(name) == (size_t)(colon - spec) && !strncmp(spec, name, colon - spec))
+			return trigger->open(dir, (PressureResource)r, false, stall_ms * 1000);
+	}
+	fprintf(stderr, "--psi resource is cpu, memory or io\n");
+	return -1;
+}
 
 int main (int argc, char **argv)
 {
 	int pid = 0;
+	long interval_ms = 0;
+	unsigned long count = 0;
+	const char *binary = NULL, *shm = NULL;
+	unsigned flags = 0;
+	const char *psi = NULL;
+	bool smaps = false, perf = false;
+	int a = 1;
+
+	for (; a < argc && !strncmp(argv[a], "--", 2); a++) {
+		if (!strcmp(argv[a], "--interval") && a + 1 < argc)
+			interval_ms = strtol(argv[++a], NULL, 10);
+		else if (!strcmp(argv[a], "--count") && a + 1 < argc)
+			count = strtoul(argv[++a], NULL, 10);
+		else if (!strcmp(argv[a], "--binary") && a + 1 < argc)
+			binary = argv[++a];
+		else if (!strcmp(argv[a], "--delta"))
+			flags |= RECORD_DELTA;
+		else if (!strcmp(argv[a], "--read") && a + 1 < argc)
+			return read_records(argv[++a]);
+		else if (!strcmp(argv[a], "--shm") && a + 1 < argc)
+			shm = argv[++a];
+		else if (!strcmp(argv[a], "--attach") && a + 1 < argc)
+			return attach_ring(argv[++a]);
+		else if (!strcmp(argv[a], "--psi") && a + 1 < argc)
+			psi = argv[++a];
+		else if (!strcmp(argv[a], "--smaps"))
+			smaps = true;
+		else if (!strcmp(argv[a], "--perf"))
+			perf = true;
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (a + 1 < argc || interval_ms < 0 || (count && !interval_ms) || 
+	    (flags && !binary) || ((shm || psi) && !interval_ms) || 
+	    (smaps && (interval_ms || binary)) || (perf && !interval_ms)) {
+		usage(argv[0]);
+		return 1;
+	}
 
-	if (argc == 2)
-		pid = (int)strtoul(argv[1], NULL, 10);
+	if (a < argc)
+		pid = (int)strtoul(argv[a], NULL, 10);
 	else
 		pid = getpid();
-		
+
 	printf("pid=%d\n", pid);
+	if (smaps)
+		return print_smaps(pid);
+
+	RecordWriter writer;
+	FILE *out = NULL;
+
+	if (binary) {
+		if ((out = fopen(binary, "wb")) == NULL || 
+		    writer.open(out, RecordWriter::recordable(), flags) < 0) {
+			perror(binary);
+			return 1;
+		}
+	}
+
+	if (interval_ms > 0) {
+		ShmRing ring;
+		PressureTrigger trigger;
+		int ret;
+
+		if (shm && ring.create(shm) < 0)
+			return 1;
+		if (psi && open_trigger(&trigger, pid, psi) < 0)
+			return 1;
+		ret = run_daemon(pid, interval_ms, count, out ? &writer : NULL, 
+		                 shm ? &ring : NULL, psi ? &trigger : NULL,
+		                 perf ? TraitSet::all() : TraitSet::defaults());
+
+		if (out)
+			fclose(out);
+		return ret;
+	}
+
+	struct SystemSnapshot snap;
+
+	if (SystemInfo::snapshot(&snap, pid) < 0)
+		fprintf(stderr, "Failed to read /proc data for pid %d\n", pid);
+
+	if (out) {
+		const int ret = writer.write(&snap);
+
+		fclose(out);
+		return ret < 0 ? 1 : 0;
+	}
 
 	for (int t(0); t < (int)Trait::N; t++) {
-		std::cout << SystemInfo::getName((Trait)t) << " - " << 
-			     SystemInfo::getSystemProperty((Trait)t, pid) << "\n";
+		std::cout << SystemInfo::getName((Trait)t) << " - " <<
+			     SystemInfo::getSnapshotProperty((Trait)t, &snap) << "\n";
 	}
-	
+
 	return 0;
 }
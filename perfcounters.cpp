@@ -0,0 +1,301 @@
+/**
+ * perfcounters.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perfcounters.hpp"
+#include "procparse.hpp"
+
+#define PERF_READ_FORMAT (PERF_FORMAT_GROUP | PERF_FORMAT_ID | \
+                          PERF_FORMAT_TOTAL_TIME_ENABLED | \
+                          PERF_FORMAT_TOTAL_TIME_RUNNING)
+
+/** what perf hands back for PERF_READ_FORMAT **/
+struct group_read {
+	uint64_t nr;
+	uint64_t time_enabled;
+	uint64_t time_running;
+	struct {
+		uint64_t value;
+		uint64_t id;
+	} values[PERF_TRAITS];
+};
+
+/** type and config of each Perf* trait, PerfIPC is derived **/
+static const struct {
+	Trait    trait;
+	uint32_t type;
+	uint64_t config;
+} perf_events[] = {
+	{ PerfCycles,          PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PerfInstructions,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PerfCacheReferences, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+	{ PerfCacheMisses,     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ PerfBranchMisses,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	{ PerfLLCLoads,        PERF_TYPE_HW_CACHE, 
+	                       PERF_COUNT_HW_CACHE_LL | 
+	                       (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+	                       (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16) },
+	{ PerfTaskClock,       PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+	{ PerfPageFaults,      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+	{ PerfContextSwitches, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+	{ PerfCPUMigrations,   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS },
+};
+
+PerfCounters::PerfCounters() : pid( -1 ),
+                               task_fd( -1 ),
+                               dirent_buf( NULL ),
+                               hardware( false )
+{
+	memset(&retired, 0, sizeof(retired));
+}
+
+PerfCounters::~PerfCounters()
+{
+	close();
+	free(dirent_buf);
+}
+
+int
+PerfCounters::openEvent (const int tid, const int leader, 
+                         const uint32_t type, const uint64_t config)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.read_format = PERF_READ_FORMAT;
+	attr.disabled = (leader < 0);
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return syscall(SYS_perf_event_open, &attr, tid, -1, leader, PERF_FLAG_FD_CLOEXEC);
+}
+
+int
+PerfCounters::openGroup (const int tid, PerfGroup *group)
+{
+	group->tid = tid;
+	group->leader = -1;
+	for (int i(0); i < PERF_TRAITS; i++) {
+		group->fds[i] = -1;
+		group->ids[i] = 0;
+	}
+
+	/** 
+	 * try the group with a hardware leader first, then with a 
+	 * software one; members that fail are simply not counted
+	 */
+	for (int pass(hardware ? 0 : 1); pass < 2 && group->leader < 0; pass++) {
+		const bool with_hardware = (pass == 0);
+
+		for (size_t e(0); e < sizeof(perf_events) / sizeof(perf_events[0]); e++) {
+			const int slot = perf_events[e].trait - PerfCycles;
+			int fd;
+
+			if (!with_hardware && perf_events[e].type != PERF_TYPE_SOFTWARE)
+				continue;
+			if ((fd = openEvent(tid, group->leader, perf_events[e].type, 
+			                    perf_events[e].config)) < 0) {
+				/** without a leader there is no group to join **/
+				if (group->leader < 0 && with_hardware)
+					break;
+				continue;
+			}
+			if (ioctl(fd, PERF_EVENT_IOC_ID, &group->ids[slot]) < 0) {
+				::close(fd);
+				continue;
+			}
+			if (group->leader < 0)
+				group->leader = fd;
+			group->fds[slot] = fd;
+		}
+		/** the first thread decides, the PMU is the same for all of them **/
+		if (group->leader < 0 && groups.empty() && next.empty())
+			hardware = false;
+	}
+
+	if (group->leader < 0)
+		return -1;
+
+	ioctl(group->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(group->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return 0;
+}
+
+void
+PerfCounters::closeGroup (PerfGroup *group)
+{
+	for (int i(0); i < PERF_TRAITS; i++) {
+		if (group->fds[i] >= 0)
+			::close(group->fds[i]);
+		group->fds[i] = -1;
+	}
+	group->leader = -1;
+}
+
+int
+PerfCounters::open (const int pid)
+{
+	return openAll(pid, true);
+}
+
+int
+PerfCounters::openAll (const int pid, const bool try_hardware)
+{
+	char path[64];
+
+	close();
+	this->pid = pid;
+	hardware = try_hardware;
+
+	if (!dirent_buf && (dirent_buf = (char *)malloc(DIRENT_BUFFER_SIZE)) == NULL)
+		return -1;
+	snprintf(path, sizeof(path), "/proc/%d/task", pid);
+	if ((task_fd = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+		return -1;
+
+	if (syncThreads() < 0 || groups.empty()) {
+		close();
+		return -1;
+	}
+	return 0;
+}
+
+void
+PerfCounters::close ()
+{
+	for (size_t g(0); g < groups.size(); g++)
+		closeGroup(&groups[g]);
+	groups.clear();
+	if (task_fd >= 0)
+		::close(task_fd);
+	task_fd = -1;
+	hardware = false;
+	memset(&retired, 0, sizeof(retired));
+}
+
+/**
+ * syncThreads - match the groups to the threads listed now, both
+ * sorted by tid: new threads are opened, threads that exited are
+ * read one last time into retired and closed.
+ */
+int
+PerfCounters::syncThreads ()
+{
+	size_t g = 0;
+
+	if (proc_list_ids(task_fd, dirent_buf, tids) < 0)
+		return -1;
+
+	next.clear();
+	for (size_t t(0); t < tids.size(); t++) {
+		PerfGroup group;
+
+		for (; g < groups.size() && groups[g].tid < tids[t]; g++) {
+			readGroup(groups[g], &retired, NULL);
+			closeGroup(&groups[g]);
+		}
+		if (g < groups.size() && groups[g].tid == tids[t]) {
+			next.push_back(groups[g++]);
+			continue;
+		}
+		if (openGroup(tids[t], &group) == 0)
+			next.push_back(group);
+	}
+	for (; g < groups.size(); g++) {
+		readGroup(groups[g], &retired, NULL);
+		closeGroup(&groups[g]);
+	}
+
+	groups.swap(next);
+	return 0;
+}
+
+/**
+ * readGroup - add the counts of one thread to sum, scaled up if
+ * the group was multiplexed off the PMU part of the time.  stalled
+ * is set if the thread ran but its hardware group never did.
+ */
+int
+PerfCounters::readGroup (const PerfGroup &group, struct PerfSample *sum, bool *stalled)
+{
+	struct group_read data;
+
+	if (::read(group.leader, &data, sizeof(data)) <= 0)
+		return -1;
+
+	if (stalled && hardware && data.time_enabled > 0 && data.time_running == 0)
+		*stalled = true;
+	sum->time_enabled += data.time_enabled;
+	sum->time_running += data.time_running;
+
+	for (uint64_t v(0); v < data.nr && v < PERF_TRAITS; v++) {
+		for (int slot(0); slot < PERF_TRAITS; slot++) {
+			if (group.fds[slot] < 0 || group.ids[slot] != data.values[v].id)
+				continue;
+
+			uint64_t count = data.values[v].value;
+
+			if (data.time_running && data.time_running < data.time_enabled)
+				count = (uint64_t)((double)count * data.time_enabled / data.time_running);
+			sum->count[slot] += count;
+			sum->available[slot] |= (data.time_running > 0);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+int
+PerfCounters::read (struct PerfSample *sample)
+{
+	bool stalled = false;
+
+	if (!sample)
+		return -1;
+
+	memset(sample, 0, sizeof(struct PerfSample));
+	if (task_fd < 0 || syncThreads() < 0 || groups.empty())
+		return -1;
+
+	*sample = retired;
+	for (size_t g(0); g < groups.size(); g++)
+		readGroup(groups[g], sample, &stalled);
+
+	/** a thread ran but the hardware group never got a counter **/
+	if (stalled) {
+		if (openAll(pid, false) < 0)
+			return -1;
+		return read(sample);
+	}
+
+	sample->hardware = hardware;
+	return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * perfcounters.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PERFCOUNTERS_HPP_
+#define _PERFCOUNTERS_HPP_  1
+#include <cstdint>
+#include <vector>
+
+#include "systeminfo.hpp"
+
+/**
+ * PerfCounters - perf_event_open groups holding the hardware
+ * events behind the Perf* traits plus the software ones, one
+ * group per thread of the pid, each read with a single read()
+ * through PERF_FORMAT_GROUP and summed.  Every read lists
+ * /proc/<pid>/task: new threads get a group, threads that exited
+ * leave their final counts in the sum.  If the hardware leader
+ * can't be opened (no PMU in VMs and most containers, or
+ * perf_event_paranoid) the groups are built from the software
+ * events alone; hardware events that a given PMU doesn't support
+ * are left out individually.  A hardware group that opens but is
+ * never scheduled onto the PMU (more events than counters, or a
+ * hypervisor that hides them) makes every thread switch to the
+ * software group at the first read that shows it, and counts
+ * start over from there.  Only user space is counted.  Each
+ * thread costs up to PERF_TRAITS fds.
+ */
+class PerfCounters
+{
+public:
+   PerfCounters();
+   ~PerfCounters();
+
+   PerfCounters( const PerfCounters &other )              = delete;
+   PerfCounters &operator = ( const PerfCounters &other ) = delete;
+
+   /**
+    * open - start counting every thread of pid, closing any
+    * previous groups.
+    * @return  int - 0 if at least one event is counting, else -1
+    */
+   int open (const int pid);
+   void close ();
+
+   bool isOpen () const { return !groups.empty(); }
+
+   /** threads - number of threads currently counted **/
+   size_t threads () const { return groups.size(); }
+
+   /**
+    * read - fill sample with the counts since open(), summed over
+    * the threads; times are summed too.
+    * @return  int - 0 on success, -1 once the process is gone
+    */
+   int read (struct PerfSample *sample);
+
+private:
+   /** PerfGroup - the events of one thread, fds[i] -1 if not counted **/
+   struct PerfGroup {
+      int      tid;
+      int      leader;
+      int      fds[ PERF_TRAITS ];
+      uint64_t ids[ PERF_TRAITS ];
+   };
+
+   int      openAll (const int pid, const bool try_hardware);
+   int      openEvent (const int tid, const int leader, 
+                       const uint32_t type, const uint64_t config);
+   int      openGroup (const int tid, PerfGroup *group);
+   void     closeGroup (PerfGroup *group);
+   int      readGroup (const PerfGroup &group, struct PerfSample *sum, bool *stalled);
+   int      syncThreads ();
+
+   int      pid;
+   int      task_fd;
+   char    *dirent_buf;
+   bool     hardware;
+   std::vector< int >       tids;
+   std::vector< PerfGroup > groups;
+   std::vector< PerfGroup > next;
+   struct PerfSample        retired; /* counts of threads that exited */
+};
+
+#endif /* END _PERFCOUNTERS_HPP_ */
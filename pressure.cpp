@@ -0,0 +1,158 @@
+/**
+ * pressure.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdio>
+#include <climits>
+#include <cstring>
+#include <cinttypes>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#include "pressure.hpp"
+#include "procparse.hpp"
+
+const char *pressure_name (const PressureResource resource)
+{
+	static const char *names[PRESSURE_RESOURCES] = { "cpu", "memory", "io" };
+
+	return names[resource];
+}
+
+/**
+ * pressure_path - the host files are /proc/pressure/<name>, a
+ * cgroup's are <dir>/<name>.pressure.
+ */
+static int pressure_path (const char *dir, const PressureResource resource, 
+                          char *path, const size_t size)
+{
+	const bool host = !strcmp(dir, PRESSURE_HOST_DIR);
+
+	return (size_t)snprintf(path, size, "%s/%s%s", dir, pressure_name(resource), 
+	                        host ? "" : ".pressure") < size ? 0 : -1;
+}
+
+int pressure_open (const char *dir, int fds[PRESSURE_RESOURCES])
+{
+	char path[PATH_MAX];
+	int opened = 0;
+
+	for (int r(0); r < PRESSURE_RESOURCES; r++) {
+		fds[r] = -1;
+		if (pressure_path(dir, (PressureResource)r, path, sizeof(path)) < 0)
+			continue;
+		if ((fds[r] = ::open(path, O_RDONLY | O_CLOEXEC)) >= 0)
+			opened++;
+	}
+	return opened;
+}
+
+int pressure_read (const int fds[PRESSURE_RESOURCES], char *buf, const size_t size,
+                   struct PressureSample samples[PRESSURE_RESOURCES])
+{
+	int ret = -1;
+
+	for (int r(0); r < PRESSURE_RESOURCES; r++) {
+		ssize_t len;
+
+		memset(&samples[r], 0, sizeof(struct PressureSample));
+		if (fds[r] < 0 || (len = proc_read_fd(fds[r], buf, size)) < 0)
+			continue;
+		if (proc_pressure_parse(buf, len, &samples[r]) == 0)
+			ret = 0;
+	}
+	return ret;
+}
+
+int pressure_read_dir (const char *dir, char *buf, const size_t size, 
+                       struct PressureSample samples[PRESSURE_RESOURCES])
+{
+	int fds[PRESSURE_RESOURCES], ret;
+
+	pressure_open(dir, fds);
+	ret = pressure_read(fds, buf, size, samples);
+	for (int r(0); r < PRESSURE_RESOURCES; r++) {
+		if (fds[r] >= 0)
+			::close(fds[r]);
+	}
+	return ret;
+}
+
+PressureTrigger::PressureTrigger() : fd( -1 )
+{
+}
+
+PressureTrigger::~PressureTrigger()
+{
+	close();
+}
+
+int
+PressureTrigger::open (const char *dir, const PressureResource resource, const bool full,
+                       const uint64_t stall_us, const uint64_t window_us)
+{
+	char path[PATH_MAX], trigger[64];
+	int len;
+
+	close();
+	if (pressure_path(dir, resource, path, sizeof(path)) < 0)
+		return -1;
+	if ((fd = ::open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC)) < 0) {
+		perror(path);
+		return -1;
+	}
+
+	/** the trigger lives as long as the fd, the write includes the NUL **/
+	len = snprintf(trigger, sizeof(trigger), "%s %" PRIu64 " %" PRIu64, 
+	               full ? "full" : "some", stall_us, window_us);
+	if (write(fd, trigger, len + 1) < 0) {
+		perror("Failed to set PSI trigger");
+		close();
+		return -1;
+	}
+	return 0;
+}
+
+void
+PressureTrigger::close ()
+{
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
+int
+PressureTrigger::wait (const int timeout_ms)
+{
+	struct pollfd pfd;
+	int n;
+
+	if (fd < 0)
+		return -1;
+
+	pfd.fd = fd;
+	pfd.events = POLLPRI;
+	pfd.revents = 0;
+	while ((n = poll(&pfd, 1, timeout_ms)) < 0 && errno == EINTR)
+		;
+	if (n < 0 || (pfd.revents & (POLLERR | POLLNVAL)))
+		return -1;
+	return n > 0 ? 1 : 0;
+}
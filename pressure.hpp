@@ -0,0 +1,105 @@
+/**
+ * pressure.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PRESSURE_HPP_
+#define _PRESSURE_HPP_  1
+#include <cstddef>
+#include <cstdint>
+
+#include "systeminfo.hpp"
+
+/** directory of the host wide PSI files **/
+#define PRESSURE_HOST_DIR "/proc/pressure"
+/** trigger window; unprivileged triggers need a multiple of 2s **/
+#define PRESSURE_WINDOW_US 2000000
+
+/**
+ * pressure_name - file name of a resource's PSI file, "cpu",
+ * "memory" or "io"; cgroups add ".pressure".
+ */
+const char *pressure_name (const PressureResource resource);
+
+/**
+ * pressure_open - open the PSI file of every resource under dir,
+ * PRESSURE_HOST_DIR or a cgroup directory.  A resource whose file
+ * can't be opened gets -1; kernels without PSI have none.
+ * @return  int - number of files opened
+ */
+int pressure_open (const char *dir, int fds[PRESSURE_RESOURCES]);
+
+/**
+ * pressure_read - pread each open fd through buf into samples;
+ * the sample of a closed or unreadable fd is zeroed.
+ * @return  int - 0 if any resource was read, -1 otherwise
+ */
+int pressure_read (const int fds[PRESSURE_RESOURCES], char *buf, const size_t size,
+                   struct PressureSample samples[PRESSURE_RESOURCES]);
+
+/**
+ * pressure_read_dir - one-shot pressure_open, pressure_read and
+ * close of dir.
+ * @return  int - 0 if any resource was read, -1 otherwise
+ */
+int pressure_read_dir (const char *dir, char *buf, const size_t size, 
+                       struct PressureSample samples[PRESSURE_RESOURCES]);
+
+/**
+ * PressureTrigger - a PSI trigger: the kernel wakes the fd with
+ * POLLPRI as soon as tasks stalled on the resource for stall_us
+ * within a window, rather than the collector finding out at its
+ * next sample.  At most one event is raised per window.
+ */
+class PressureTrigger
+{
+public:
+   PressureTrigger();
+   ~PressureTrigger();
+
+   PressureTrigger( const PressureTrigger &other )              = delete;
+   PressureTrigger &operator = ( const PressureTrigger &other ) = delete;
+
+   /**
+    * open - arm a trigger on the resource's PSI file under dir.
+    * @param dir - PRESSURE_HOST_DIR or a cgroup directory
+    * @param full - trigger on full instead of some stalls
+    * @param stall_us - stall time in the window that fires, <= window_us
+    * @param window_us - 500 ms to 10 s
+    * @return  int - 0 on success, -1 on failure (no PSI, EPERM)
+    */
+   int open (const char *dir, const PressureResource resource, const bool full, 
+             const uint64_t stall_us, const uint64_t window_us = PRESSURE_WINDOW_US);
+
+   void close ();
+
+   /**
+    * wait - block until the trigger fires or timeout_ms passes,
+    * -1 waits forever.
+    * @return  int - 1 if it fired, 0 on timeout, -1 on error or if
+    * the file went away (cgroup removed)
+    */
+   int wait (const int timeout_ms);
+
+   /** getFd - for callers that poll() it with other fds, POLLPRI **/
+   int getFd () const { return fd; }
+
+private:
+   int fd;
+};
+
+#endif /* END _PRESSURE_HPP_ */
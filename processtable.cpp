@@ -0,0 +1,493 @@
+/**
+ * processtable.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+
+#include "processtable.hpp"
+#include "procparse.hpp"
+#include "collectorpool.hpp"
+#include "procuring.hpp"
+
+/** stat_fd of an entry whose fd is opened by whoever reads it first **/
+#define ENTRY_UNOPENED     -2
+/** a stat line is at most ~1.1 kB even with every field at full width **/
+#define STAT_SLOT_SIZE     2048
+#define EXECUTABLE_WIDTH   sizeof(ProcStatData::executable)
+/** the rest of RLIMIT_NOFILE is left to the caller **/
+#define PROC_FD_SHARE      2
+
+static void close_entry (ProcEntry &e)
+{
+	if (e.stat_fd >= 0)
+		close(e.stat_fd);
+	if (e.status_fd >= 0)
+		close(e.status_fd);
+	e.stat_fd = e.status_fd = -1;
+}
+
+/**
+ * merge_entries - walk the sorted id list alongside the sorted
+ * entries of the previous sample: entries still listed are kept
+ * with their fds, new ids are opened with open_entry and ids that
+ * are gone are closed.  The result is swapped into entries.
+ * @return  size_t - number of entries evicted
+ */
+template <class Open> static size_t
+merge_entries (const std::vector< int > &ids, 
+               std::vector< ProcEntry > &entries,
+               std::vector< ProcEntry > &next,
+               Open open_entry)
+{
+	size_t i = 0, evicted = 0;
+
+	next.clear();
+	for (size_t p(0); p < ids.size(); p++) {
+		while (i < entries.size() && entries[i].id < ids[p]) {
+			close_entry(entries[i++]);
+			evicted++;
+		}
+
+		if (i < entries.size() && entries[i].id == ids[p]) {
+			next.push_back(entries[i++]);
+		}
+		else {
+			ProcEntry e = { ids[p], -1, -1 };
+
+			open_entry(e);
+			next.push_back(e);
+		}
+	}
+	for (; i < entries.size(); i++) {
+		close_entry(entries[i]);
+		evicted++;
+	}
+	entries.swap(next);
+
+	return evicted;
+}
+
+/**
+ * reread - refresh fd into buf; a failed read on an id that was
+ * just listed means the id has been reused, so reopen and retry
+ * once before giving up.
+ */
+template <class Reopen> static ssize_t
+reread (int &fd, char *buf, Reopen reopen)
+{
+	ssize_t len;
+
+	if ((len = proc_read_fd(fd, buf, PROC_BUFFER_SIZE)) >= 0)
+		return len;
+
+	if (fd >= 0)
+		close(fd);
+	fd = reopen();
+	return proc_read_fd(fd, buf, PROC_BUFFER_SIZE);
+}
+
+static char *alloc_proc_buffer ()
+{
+	void *ptr = NULL;
+
+	if (posix_memalign(&ptr, PROC_BUFFER_ALIGN, PROC_BUFFER_SIZE) != 0) {
+		perror("Failed to allocate proc buffer");
+		return NULL;
+	}
+	return (char *)ptr;
+}
+
+static char *alloc_dirent_buffer ()
+{
+	char *ptr;
+
+	if ((ptr = (char *)malloc(DIRENT_BUFFER_SIZE)) == NULL)
+		perror("Failed to allocate dirent buffer");
+	return ptr;
+}
+
+ProcessTable::ProcessTable() : pool( NULL ),
+                               uring( NULL ),
+                               proc_fd( -1 ),
+                               dirent_buf( alloc_dirent_buffer() ),
+                               buf( alloc_proc_buffer() ),
+                               rows( 0 ),
+                               last_evicted( 0 ),
+                               fd_budget( 0 ),
+                               open_fds( 0 )
+{
+	struct rlimit limit;
+
+	if ((proc_fd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+		perror("Failed to open /proc");
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+		fd_budget = limit.rlim_cur / PROC_FD_SHARE;
+	else
+		fd_budget = (size_t)-1;
+}
+
+ProcessTable::~ProcessTable()
+{
+	for (size_t i(0); i < entries.size(); i++)
+		close_entry(entries[i]);
+	if (proc_fd >= 0)
+		close(proc_fd);
+	releaseWorkerBuffers();
+	delete uring;
+	free(dirent_buf);
+	free(buf);
+}
+
+void
+ProcessTable::releaseWorkerBuffers ()
+{
+	for (size_t w(0); w < worker_bufs.size(); w++)
+		free(worker_bufs[w]);
+	worker_bufs.clear();
+}
+
+int
+ProcessTable::setPool (CollectorPool *pool)
+{
+	releaseWorkerBuffers();
+	this->pool = NULL;
+	if (!pool)
+		return 0;
+
+	for (size_t w(0); w < pool->workers(); w++) {
+		char *worker_buf = alloc_proc_buffer();
+
+		if (!worker_buf) {
+			releaseWorkerBuffers();
+			return -1;
+		}
+		worker_bufs.push_back(worker_buf);
+	}
+	this->pool = pool;
+	return 0;
+}
+
+int
+ProcessTable::setUring (const bool enable)
+{
+	delete uring;
+	uring = NULL;
+	if (!enable)
+		return 0;
+
+	uring = new ProcUring();
+	return uring->open(STAT_SLOT_SIZE);
+}
+
+uint64_t
+ProcessTable::uringSyscalls () const
+{
+	return uring ? uring->syscalls() : 0;
+}
+
+void
+ProcessTable::openEntry (ProcEntry &e)
+{
+	char path[32];
+
+	snprintf(path, sizeof(path), "%d/stat", e.id);
+	/** 
+	 * over budget or out of fds the entry is still sampled, just
+	 * with an open/read/close each time instead of a persistent fd
+	 */
+	e.stat_fd = -1;
+	if (open_fds.fetch_add(1, std::memory_order_relaxed) >= fd_budget) {
+		open_fds.fetch_sub(1, std::memory_order_relaxed);
+		return;
+	}
+	if ((e.stat_fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC)) < 0)
+		open_fds.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int
+ProcessTable::readEntry (ProcEntry &e, char *buf, struct ProcStatData *data)
+{
+	ssize_t len;
+
+	if (e.stat_fd == ENTRY_UNOPENED)
+		openEntry(e);
+
+	if (e.stat_fd >= 0) {
+		len = reread(e.stat_fd, buf, [&]() {
+			openEntry(e);
+			return e.stat_fd;
+		});
+	}
+	else {
+		char path[64];
+
+		snprintf(path, sizeof(path), "/proc/%d/stat", e.id);
+		len = proc_read_file(path, buf, PROC_BUFFER_SIZE);
+	}
+
+	if (len < 0)
+		return -1;
+	return proc_stat_parse(buf, len, data);
+}
+
+int
+ProcessTable::refresh ()
+{
+	/** the constructor could not allocate them, already reported **/
+	if (!dirent_buf || !buf)
+		return -1;
+	if (proc_list_ids(proc_fd, dirent_buf, pids) < 0) {
+		perror("Failed to list /proc");
+		return -1;
+	}
+
+	/** opening is left to the reader so new pids are opened in parallel too **/
+	last_evicted = merge_entries(pids, entries, next, [&](ProcEntry &e) {
+		e.stat_fd = ENTRY_UNOPENED;
+	});
+
+	const size_t count = entries.size();
+	size_t kept = 0;
+
+	/** 
+	 * entries read by name last time try for an fd again, there may
+	 * be room now that others exited
+	 */
+	for (size_t e(0); e < count; e++) {
+		if (entries[e].stat_fd >= 0)
+			kept++;
+		else
+			entries[e].stat_fd = ENTRY_UNOPENED;
+	}
+	open_fds.store(kept, std::memory_order_relaxed);
+
+	for (int c(0); c < PROC_STAT_FIELDS; c++)
+		columns[c].resize(count);
+	executables.resize(count * EXECUTABLE_WIDTH);
+	/** a row only counts if this pass read it **/
+	read_ok.assign(count, false);
+
+	/** row e belongs to entry e, so no two readers touch the same slot **/
+	auto store_row = [&](const size_t e, const struct ProcStatData *data) {
+		for (int c(0); c < PROC_STAT_FIELDS; c++)
+			columns[c][e] = proc_stat_field(data, (Trait)(pid1 + c));
+		memcpy(&executables[e * EXECUTABLE_WIDTH], data->executable, 
+		       EXECUTABLE_WIDTH);
+	};
+	auto read_row = [&](char *row_buf, const size_t e) {
+		struct ProcStatData data;
+
+		/** exited between the listing and the read, evicted next time **/
+		read_ok[e] = (readEntry(entries[e], row_buf, &data) == 0);
+		if (read_ok[e])
+			store_row(e, &data);
+	};
+
+	if (pool) {
+		pool->run(count, [&](size_t worker, size_t e) {
+			read_row(worker_bufs[worker], e);
+		});
+	}
+	else if (uring) {
+		stat_fds.resize(count);
+		for (size_t e(0); e < count; e++) {
+			if (entries[e].stat_fd == ENTRY_UNOPENED)
+				openEntry(entries[e]);
+			stat_fds[e] = entries[e].stat_fd;
+		}
+
+		reported.assign(count, false);
+		const int ret = uring->read(stat_fds.data(), count, 
+		                            [&](size_t e, char *slot, ssize_t len) {
+			struct ProcStatData data;
+
+			reported[e] = true;
+			/** 
+			 * failed reads take the regular path, which reopens a
+			 * reused pid or reads by name when we are out of fds
+			 */
+			if (len < 0 || proc_stat_parse(slot, len, &data) < 0) {
+				read_row(buf, e);
+				return;
+			}
+			read_ok[e] = true;
+			store_row(e, &data);
+		});
+
+		/** the ring failed partway, read what it never got to **/
+		if (ret < 0) {
+			for (size_t e(0); e < count; e++) {
+				if (!reported[e])
+					read_row(buf, e);
+			}
+		}
+	}
+	else {
+		for (size_t e(0); e < count; e++)
+			read_row(buf, e);
+	}
+
+	/** close the gaps left by failed reads, keeping pid order **/
+	rows = 0;
+	for (size_t e(0); e < count; e++) {
+		if (!read_ok[e])
+			continue;
+		if (rows != e) {
+			for (int c(0); c < PROC_STAT_FIELDS; c++)
+				columns[c][rows] = columns[c][e];
+			memcpy(&executables[rows * EXECUTABLE_WIDTH], 
+			       &executables[e * EXECUTABLE_WIDTH], EXECUTABLE_WIDTH);
+		}
+		rows++;
+	}
+
+	return 0;
+}
+
+const uint64_t *
+ProcessTable::column (const Trait t) const
+{
+	if (t < pid1 || t > child_guest_time || t == executable)
+		return NULL;
+	return columns[t - pid1].data();
+}
+
+const char *
+ProcessTable::getExecutable (const size_t row) const
+{
+	if (row >= rows)
+		return NULL;
+	return &executables[row * EXECUTABLE_WIDTH];
+}
+
+TaskTable::TaskTable() : pid( -1 ),
+                         task_fd( -1 ),
+                         dirent_buf( alloc_dirent_buffer() ),
+                         buf( alloc_proc_buffer() ),
+                         rows( 0 ),
+                         last_evicted( 0 )
+{
+}
+
+TaskTable::~TaskTable()
+{
+	release();
+	free(dirent_buf);
+	free(buf);
+}
+
+void
+TaskTable::release ()
+{
+	for (size_t i(0); i < entries.size(); i++)
+		close_entry(entries[i]);
+	entries.clear();
+	if (task_fd >= 0)
+		close(task_fd);
+	task_fd = -1;
+	rows = 0;
+}
+
+int
+TaskTable::open (const int pid)
+{
+	char path[64];
+
+	release();
+	this->pid = pid;
+
+	if (!dirent_buf || !buf)
+		return -1;
+	snprintf(path, sizeof(path), "/proc/%d/task", pid);
+	if ((task_fd = ::open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+		return -1;
+
+	return 0;
+}
+
+void
+TaskTable::openEntry (ProcEntry &e)
+{
+	char path[32];
+
+	snprintf(path, sizeof(path), "%d/stat", e.id);
+	e.stat_fd = openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+	snprintf(path, sizeof(path), "%d/status", e.id);
+	e.status_fd = openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+}
+
+int
+TaskTable::readEntry (ProcEntry &e, TaskSample *sample)
+{
+	char path[32];
+	ssize_t len;
+
+	sample->tid = e.id;
+
+	len = reread(e.stat_fd, buf, [&]() {
+		snprintf(path, sizeof(path), "%d/stat", e.id);
+		return openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+	});
+	if (len < 0 || proc_stat_parse(buf, len, &sample->stat) < 0)
+		return -1;
+
+	len = reread(e.status_fd, buf, [&]() {
+		snprintf(path, sizeof(path), "%d/status", e.id);
+		return openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+	});
+	if (len < 0 || proc_status_parse(buf, len, &sample->status) < 0)
+		return -1;
+
+	return 0;
+}
+
+int
+TaskTable::refresh ()
+{
+	if (proc_list_ids(task_fd, dirent_buf, tids) < 0) {
+		rows = 0;
+		return -1;
+	}
+
+	last_evicted = merge_entries(tids, entries, next, [&](ProcEntry &e) {
+		openEntry(e);
+	});
+
+	/** a live process has at least its main thread **/
+	if (tids.empty()) {
+		rows = 0;
+		return -1;
+	}
+
+	if (samples.size() < entries.size())
+		samples.resize(entries.size());
+
+	rows = 0;
+	for (size_t e(0); e < entries.size(); e++) {
+		if (readEntry(entries[e], &samples[rows]) == 0)
+			rows++;
+	}
+
+	return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * processtable.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PROCESSTABLE_HPP_
+#define _PROCESSTABLE_HPP_  1
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+#include "systeminfo.hpp"
+
+class CollectorPool;
+class ProcUring;
+
+/** number of stat traits, pid1 through child_guest_time **/
+#define PROC_STAT_FIELDS (child_guest_time - pid1 + 1)
+
+/**
+ * ProcEntry - per-pid (or per-tid) state kept between samples,
+ * the fds stay open until the task exits.
+ */
+struct ProcEntry {
+   int id;
+   int stat_fd;
+   int status_fd;
+};
+
+/**
+ * ProcessTable - samples /proc/<pid>/stat for every process on
+ * the host in one pass.  /proc is enumerated with getdents64,
+ * each pid keeps its stat fd open across samples and is dropped
+ * once it exits.  Each refresh() lays the results out as one
+ * contiguous column per stat trait (struct of arrays) so that
+ * aggregating a field over all processes walks a single array.
+ * After the first few samples a refresh allocates nothing.
+ * With a CollectorPool set the reads are spread over its workers,
+ * each with its own buffer, and every row is written only by the
+ * worker that read it.  With io_uring enabled instead, the reads
+ * of all pids are batched through a ProcUring.  At most half of
+ * RLIMIT_NOFILE is spent on kept fds; pids beyond that, or whose
+ * open failed, are read by name and get another try at an fd on
+ * the next refresh.
+ */
+class ProcessTable
+{
+public:
+   ProcessTable();
+   ~ProcessTable();
+
+   ProcessTable( const ProcessTable &other )              = delete;
+   ProcessTable &operator = ( const ProcessTable &other ) = delete;
+
+   /**
+    * refresh - enumerate /proc and re-read every process.
+    * @return  int - 0 on success, -1 if /proc can't be read
+    */
+   int refresh ();
+
+   /**
+    * size - number of rows (processes) from the last refresh.
+    */
+   size_t size () const { return rows; }
+
+   /**
+    * column - the values of stat trait t for every row, widened
+    * to 64 bits (signed fields two's complement, state as its
+    * character).  Returns NULL for executable and non-stat traits.
+    * @param t - const Trait, pid1 through child_guest_time
+    * @return  const uint64_t * - size() values
+    */
+   const uint64_t *column (const Trait t) const;
+
+   /**
+    * getExecutable - "(comm)" of row, see ProcStatData::executable.
+    */
+   const char *getExecutable (const size_t row) const;
+
+   /**
+    * evicted - number of pids dropped by the last refresh because
+    * they had exited.
+    */
+   size_t evicted () const { return last_evicted; }
+
+   /**
+    * setPool - read through pool's workers from now on, NULL to go
+    * back to reading on the calling thread.  The pool must outlive
+    * the table or be unset first.
+    * @return  int - 0 on success, -1 if the worker buffers could not
+    *          be allocated, the table then reads on the calling thread
+    */
+   int setPool (CollectorPool *pool);
+
+   /**
+    * setUring - batch the stat reads through io_uring when no pool
+    * is set.  Enabling still works without io_uring, the reads fall
+    * back to pread.
+    * @return  int - 0 if io_uring is in use, -1 if it fell back
+    */
+   int setUring (const bool enable);
+
+   /** syscalls - reads issued through the io_uring backend so far **/
+   uint64_t uringSyscalls () const;
+
+protected:
+   void openEntry (ProcEntry &e);
+   int  readEntry (ProcEntry &e, char *buf, struct ProcStatData *data);
+   void releaseWorkerBuffers ();
+
+   CollectorPool        *pool;
+   ProcUring            *uring;
+   std::vector< int >    stat_fds;
+   std::vector< char * > worker_bufs;
+   std::vector< char >   read_ok;
+   std::vector< char >   reported; /* by the uring, this pass */
+   int                   proc_fd;
+   char                 *dirent_buf;
+   char                 *buf;
+   std::vector< int >    pids;
+   std::vector< ProcEntry > entries;
+   std::vector< ProcEntry > next;
+   std::vector< uint64_t > columns[ PROC_STAT_FIELDS ];
+   std::vector< char >   executables;
+   size_t                rows;
+   size_t                last_evicted;
+   size_t                fd_budget; /* kept stat fds allowed */
+   std::atomic< size_t > open_fds;  /* kept stat fds, or reserved */
+};
+
+/**
+ * TaskSample - one thread of the process a TaskTable watches.
+ */
+struct TaskSample {
+   int                   tid;
+   struct ProcStatData   stat;
+   struct ProcStatusData status;
+};
+
+/**
+ * TaskTable - per-thread counterpart of ProcessTable for a single
+ * process: refresh() lists /proc/<pid>/task and reads each
+ * thread's stat and status through fds kept open across samples,
+ * with the same parsers as the process level traits.  Samples
+ * are handed out through a const iterator over storage that is
+ * reused, so a steady state refresh does not allocate per thread.
+ */
+class TaskTable
+{
+public:
+   typedef std::vector< TaskSample >::const_iterator const_iterator;
+
+   TaskTable();
+   ~TaskTable();
+
+   TaskTable( const TaskTable &other )              = delete;
+   TaskTable &operator = ( const TaskTable &other ) = delete;
+
+   /**
+    * open - watch the threads of pid, dropping any previous pid.
+    * @return  int - 0 on success, -1 if pid has no task directory
+    */
+   int open (const int pid);
+
+   /**
+    * refresh - list the threads and re-read each of them.
+    * @return  int - 0 on success, -1 if the process is gone, which
+    *          leaves the table empty
+    */
+   int refresh ();
+
+   int getPid () const { return pid; }
+   size_t size () const { return rows; }
+   size_t evicted () const { return last_evicted; }
+
+   const_iterator begin () const { return samples.begin(); }
+   const_iterator end () const { return samples.begin() + rows; }
+
+protected:
+   void openEntry (ProcEntry &e);
+   int  readEntry (ProcEntry &e, TaskSample *sample);
+   void release ();
+
+   int                   pid;
+   int                   task_fd;
+   char                 *dirent_buf;
+   char                 *buf;
+   std::vector< int >    tids;
+   std::vector< ProcEntry > entries;
+   std::vector< ProcEntry > next;
+   std::vector< TaskSample > samples;
+   size_t                rows;
+   size_t                last_evicted;
+};
+
+#endif /* END _PROCESSTABLE_HPP_ */
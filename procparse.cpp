@@ -0,0 +1,747 @@
+/**
+ * procparse.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+
+#include "procparse.hpp"
+
+/** layout the kernel fills in for getdents64 **/
+struct linux_dirent64 {
+	uint64_t       d_ino;
+	int64_t        d_off;
+	unsigned short d_reclen;
+	unsigned char  d_type;
+	char           d_name[];
+};
+
+int proc_list_ids (const int dir_fd, char *dirent_buf, std::vector< int > &ids)
+{
+	long n;
+
+	if (dir_fd < 0 || lseek(dir_fd, 0, SEEK_SET) < 0)
+		return -1;
+
+	ids.clear();
+
+	while ((n = syscall(SYS_getdents64, dir_fd, dirent_buf, DIRENT_BUFFER_SIZE)) > 0) {
+		for (long off(0); off < n; ) {
+			const struct linux_dirent64 *d = 
+				(const struct linux_dirent64 *)(dirent_buf + off);
+			const char *name = d->d_name;
+			int id = 0;
+
+			off += d->d_reclen;
+			if (d->d_type != DT_DIR && d->d_type != DT_UNKNOWN)
+				continue;
+			while ((unsigned)(*name - '0') < 10)
+				id = id * 10 + (*name++ - '0');
+			if (*name == '\0' && id > 0)
+				ids.push_back(id);
+		}
+	}
+
+	if (n < 0)
+		return -1;
+
+	/** /proc lists ids in order already, this is almost free **/
+	std::sort(ids.begin(), ids.end());
+	return 0;
+}
+
+ssize_t proc_read_file (const char *path, char *buf, size_t size)
+{
+	int fd;
+	ssize_t len = 0, n;
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return -1;
+
+	while ((size_t)len < size - 1 && 
+	       (n = read(fd, buf + len, size - 1 - len)) > 0)
+		len += n;
+
+	close(fd);
+
+	if (len <= 0)
+		return -1;
+
+	buf[len] = '\0';
+	return len;
+}
+
+ssize_t proc_read_fd (const int fd, char *buf, size_t size)
+{
+	ssize_t len;
+
+	if (fd < 0 || (len = pread(fd, buf, size - 1, 0)) <= 0)
+		return -1;
+
+	buf[len] = '\0';
+	return len;
+}
+
+/**
+ * Digit decoding for the stat parser.  The buffer is NUL
+ * terminated, so the scalar loops need no bounds checks: the
+ * terminator is neither a blank nor a digit.  Long fields
+ * (addresses, sizes, rlimits) are converted eight digits at a
+ * time with 64-bit arithmetic (SWAR); for the short counters
+ * that make up most of the file the check costs more than it
+ * saves, so they stay scalar.
+ */
+static inline uint64_t next_unsigned (const char **pp)
+{
+	const char *p = *pp;
+	uint64_t v = 0;
+
+	while (*p == ' ')
+		p++;
+	while ((unsigned)(*p - '0') < 10)
+		v = v * 10 + (*p++ - '0');
+
+	*pp = p;
+	return v;
+}
+
+static inline int64_t next_signed (const char **pp)
+{
+	const char *p = *pp;
+	bool neg;
+
+	while (*p == ' ')
+		p++;
+	neg = (*p == '-');
+	*pp = p + neg;
+
+	const uint64_t v = next_unsigned(pp);
+	return neg ? -(int64_t)v : (int64_t)v;
+}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+static inline bool is_eight_digits (const char *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+	         (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+	        0x3333333333333333ULL);
+}
+
+static inline uint64_t eight_digits (const char *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	v -= 0x3030303030303030ULL;
+	v = (v * 10) + (v >> 8);
+	v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+	     (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+	return v;
+}
+
+/** only loads that lie entirely inside [p, end) are made **/
+static inline uint64_t next_wide (const char **pp, const char *end)
+{
+	const char *p = *pp;
+	uint64_t v = 0;
+
+	while (*p == ' ')
+		p++;
+	while (end - p >= 8 && is_eight_digits(p)) {
+		v = v * 100000000ULL + eight_digits(p);
+		p += 8;
+	}
+	while ((unsigned)(*p - '0') < 10)
+		v = v * 10 + (*p++ - '0');
+
+	*pp = p;
+	return v;
+}
+#else
+static inline uint64_t next_wide (const char **pp, const char *end)
+{
+	(void)end;
+	return next_unsigned(pp);
+}
+#endif
+
+int proc_stat_parse (const char *buf, size_t len, struct ProcStatData *data)
+{
+	const char *end = buf + len, *p, *open, *close;
+	size_t comm_len;
+
+	if (!data || len == 0)
+		return -1;
+
+	memset(data, 0, sizeof(struct ProcStatData));
+
+	/** 
+	 * the executable can contain spaces and parentheses, so it runs
+	 * from the first '(' to the last ')' rather than to a blank
+	 */
+	if ((open = (const char *)memchr(buf, '(', len)) == NULL ||
+	    (close = (const char *)memrchr(open, ')', end - open)) == NULL)
+		return -1;
+
+	p = buf;
+	data->pid = next_signed(&p);
+
+	comm_len = close - open + 1;
+	if (comm_len > sizeof(data->executable) - 1)
+		comm_len = sizeof(data->executable) - 1;
+	memcpy(data->executable, open, comm_len);
+	data->executable[comm_len] = '\0';
+
+	p = close + 1;
+	while (*p == ' ')
+		p++;
+	if (*p == '\0')
+		return -1;
+	data->state = *p++;
+
+	data->parent_pid = next_signed(&p);
+	data->group_id = next_signed(&p);
+	data->session_id = next_signed(&p);
+	data->tty_nr = next_signed(&p);
+	data->foreground_id = next_signed(&p);
+	data->flags = next_unsigned(&p);
+	data->minor_faults = next_unsigned(&p);
+	data->child_minor_faults = next_unsigned(&p);
+	data->major_faults = next_unsigned(&p);
+	data->child_major_faults = next_unsigned(&p);
+	data->uptime = next_unsigned(&p);
+	data->scheduled_time = next_unsigned(&p);
+	data->child_uptime = next_signed(&p);
+	data->child_scheduled_time = next_signed(&p);
+	data->priority = next_signed(&p);
+	data->nice = next_signed(&p);
+	data->number_threads = next_signed(&p);
+	data->itrealvalue = next_signed(&p);
+	data->start_time = next_unsigned(&p);
+	data->virtual_mem_size_bytes = next_wide(&p, end);
+	data->resident_mem_size = next_signed(&p);
+	data->resident_mem_soft_limit = next_wide(&p, end);
+	data->startcode = next_wide(&p, end);
+	data->endcode = next_wide(&p, end);
+	data->startstack = next_wide(&p, end);
+	data->curr_esp = next_wide(&p, end);
+	data->curr_eip = next_wide(&p, end);
+	data->signal_unused = next_unsigned(&p);
+	next_unsigned(&p); /* blocked, not kept */
+	data->signal_ignore_unused = next_unsigned(&p);
+	data->signal_caught_unused = next_unsigned(&p);
+	data->channel = next_wide(&p, end);
+	data->pages_swapped = next_unsigned(&p);
+	data->cumulative_child_swapped_pages = next_unsigned(&p);
+	data->exit_signal = next_signed(&p);
+	data->processor_last_executed_on = next_signed(&p);
+	data->rt_schedule = next_unsigned(&p);
+	data->policy = next_unsigned(&p);
+	data->delayed_io_ticks = next_unsigned(&p);
+	data->guest_time = next_unsigned(&p);
+	data->child_guest_time = next_signed(&p);
+
+	return 0;
+}
+
+uint64_t proc_stat_field (const struct ProcStatData *data, const Trait trait)
+{
+	switch (trait) {
+		case pid1:
+			return (int64_t)data->pid;
+		case state:
+			return data->state;
+		case parent_pid: 
+			return (int64_t)data->parent_pid;
+		case group_id:
+			return (int64_t)data->group_id;
+		case session_id:
+			return (int64_t)data->session_id;
+		case tty_nr:
+			return (int64_t)data->tty_nr;
+		case foreground_id:
+			return (int64_t)data->foreground_id;
+		case flags:
+			return data->flags;
+		case minor_faults:
+			return data->minor_faults;
+		case child_minor_faults:
+			return data->child_minor_faults;
+		case major_faults:
+			return data->major_faults;
+		case child_major_faults:
+			return data->child_major_faults;
+		case uptime:
+			return data->uptime;
+		case scheduled_time:
+			return data->scheduled_time;
+		case child_uptime:
+			return (int64_t)data->child_uptime;
+		case child_scheduled_time:
+			return (int64_t)data->child_scheduled_time;
+		case priority1:
+			return (int64_t)data->priority;
+		case nice1:
+			return (int64_t)data->nice;
+		case number_threads:
+			return (int64_t)data->number_threads;
+		case itrealvalue:
+			return (int64_t)data->itrealvalue;
+		case start_time:
+			return data->start_time;
+		case virtual_mem_size_bytes:
+			return data->virtual_mem_size_bytes;
+		case resident_mem_size:
+			return (int64_t)data->resident_mem_size;
+		case resident_mem_soft_limit:
+			return data->resident_mem_soft_limit;
+		case startcode:
+			return data->startcode;
+		case endcode:
+			return data->endcode;
+		case startstack:
+			return data->startstack;
+		case curr_esp:
+			return data->curr_esp;
+		case curr_eip:
+			return data->curr_eip;
+		case signal_unused:
+			return data->signal_unused;
+		case signal_ignore_unused:
+			return data->signal_ignore_unused;
+		case signal_caught_unused:
+			return data->signal_caught_unused;
+		case channel:
+			return data->channel;
+		case pages_swapped:
+			return data->pages_swapped;
+		case cumulative_child_swapped_pages:
+			return data->cumulative_child_swapped_pages;
+		case exit_signal:
+			return (int64_t)data->exit_signal;
+		case processor_last_executed_on:
+			return (int64_t)data->processor_last_executed_on;
+		case rt_schedule:
+			return data->rt_schedule;
+		case policy:
+			return data->policy;
+		case delayed_io_ticks:
+			return data->delayed_io_ticks;
+		case guest_time:
+			return data->guest_time;
+		case child_guest_time:
+			return (int64_t)data->child_guest_time;
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+/**
+ * KeyTable - names of a contiguous range of traits, taken from
+ * SystemInfo::getName and sorted once so that each "key: value"
+ * line is matched with a binary search on the exact key.  Prefix
+ * matching would let "Active" claim "Active(anon)".  skip drops a
+ * prefix the trait names carry and the file's keys don't.
+ */
+class KeyTable
+{
+public:
+	KeyTable (const Trait first, const Trait last, const size_t skip = 0)
+	{
+		for (int t(first); t <= last; t++) {
+			const char *name = SystemInfo::getName((Trait)t) + skip;
+			NamedKey key = { name, strlen(name), (Trait)t };
+
+			keys.push_back(key);
+		}
+		std::sort(keys.begin(), keys.end(), 
+		          [](const NamedKey &a, const NamedKey &b) {
+			return compare(a.name, a.len, b.name, b.len) < 0;
+		});
+	}
+
+	/**
+	 * find - trait whose name is exactly key[0, len), or -1.
+	 */
+	int find (const char *key, const size_t len) const
+	{
+		size_t lo = 0, hi = keys.size();
+
+		while (lo < hi) {
+			const size_t mid = (lo + hi) / 2;
+			const int cmp = compare(keys[mid].name, keys[mid].len, key, len);
+
+			if (cmp == 0)
+				return keys[mid].trait;
+			else if (cmp < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		return -1;
+	}
+
+private:
+	struct NamedKey {
+		const char *name;
+		size_t      len;
+		Trait       trait;
+	};
+
+	static int compare (const char *a, const size_t a_len, 
+	                    const char *b, const size_t b_len)
+	{
+		const int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+
+		if (cmp != 0)
+			return cmp;
+		return (a_len > b_len) - (a_len < b_len);
+	}
+
+	std::vector<NamedKey> keys;
+};
+
+int proc_status_parse (const char *buf, size_t len, struct ProcStatusData *data)
+{
+	static const KeyTable table(voluntary_ctxt_switches, nonvoluntary_ctxt_switches);
+
+	if (!data)
+		return -1;
+
+	memset(data, 0, sizeof(struct ProcStatusData));
+
+	for_each_named_line(buf, len, [&](const char *key, size_t key_len, const char *val) {
+		switch (table.find(key, key_len)) {
+			case voluntary_ctxt_switches:
+				data->voluntary_context_swaps = next_unsigned(&val);
+				break;
+			case nonvoluntary_ctxt_switches:
+				data->non_voluntary_context_swaps = next_unsigned(&val);
+				break;
+			default:
+				break;
+		}
+		return true;
+	});
+
+	return 0;
+}
+
+int proc_meminfo_parse (const char *buf, size_t len, uint64_t *meminfo)
+{
+	static const KeyTable table(MemTotal, Hugepagesize);
+
+	if (!meminfo)
+		return -1;
+
+	memset(meminfo, 0, sizeof(uint64_t) * (Hugepagesize - MemTotal + 1));
+
+	for_each_named_line(buf, len, [&](const char *key, size_t key_len, const char *val) {
+		const int t = table.find(key, key_len);
+
+		if (t >= 0)
+			meminfo[t - MemTotal] = next_unsigned(&val);
+		return true;
+	});
+
+	return 0;
+}
+
+int proc_io_parse (const char *buf, size_t len, struct ProcIOData *data)
+{
+	static const KeyTable table(rchar, cancelled_write_bytes);
+
+	if (!data)
+		return -1;
+
+	memset(data, 0, sizeof(struct ProcIOData));
+
+	for_each_named_line(buf, len, [&](const char *key, size_t key_len, const char *val) {
+		switch (table.find(key, key_len)) {
+			case rchar:
+				data->rchar = next_unsigned(&val);
+				break;
+			case wchar:
+				data->wchar = next_unsigned(&val);
+				break;
+			case syscr:
+				data->syscr = next_unsigned(&val);
+				break;
+			case syscw:
+				data->syscw = next_unsigned(&val);
+				break;
+			case read_bytes:
+				data->read_bytes = next_unsigned(&val);
+				break;
+			case write_bytes:
+				data->write_bytes = next_unsigned(&val);
+				break;
+			case cancelled_write_bytes:
+				data->cancelled_write_bytes = next_unsigned(&val);
+				break;
+			default:
+				break;
+		}
+		return true;
+	});
+
+	return 0;
+}
+
+int proc_pressure_parse (const char *buf, size_t len, struct PressureSample *sample)
+{
+	const char *p = buf, *end = buf + len;
+	bool have_some = false;
+
+	if (!sample)
+		return -1;
+
+	memset(sample, 0, sizeof(struct PressureSample));
+
+	/** "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456" **/
+	while (p < end) {
+		const char *eol = (const char *)memchr(p, '\n', end - p);
+		struct PressureLine *line = NULL;
+
+		if (!eol)
+			eol = end;
+		if (!strncmp(p, "some ", 5)) {
+			line = &sample->some;
+			have_some = true;
+		}
+		else if (!strncmp(p, "full ", 5))
+			line = &sample->full;
+
+		while (line && p < eol) {
+			const char *eq = (const char *)memchr(p, '=', eol - p);
+			char *next;
+
+			if (!eq)
+				break;
+			if (!strncmp(eq - 5, "avg10", 5))
+				line->avg10 = strtod(eq + 1, &next);
+			else if (!strncmp(eq - 5, "avg60", 5))
+				line->avg60 = strtod(eq + 1, &next);
+			else if (!strncmp(eq - 6, "avg300", 6))
+				line->avg300 = strtod(eq + 1, &next);
+			else if (!strncmp(eq - 5, "total", 5)) {
+				p = eq + 1;
+				line->total = next_unsigned(&p);
+				continue;
+			}
+			else
+				next = (char *)eq + 1;
+			p = next;
+		}
+		p = eol + 1;
+	}
+
+	return have_some ? 0 : -1;
+}
+
+/**
+ * flat_keyed_parse - the "key value" lines of cgroup files such as
+ * memory.stat, value stored at values[trait - first].
+ */
+static void flat_keyed_parse (const KeyTable &table, const Trait first, 
+                              const char *buf, size_t len, uint64_t *values)
+{
+	const char *p = buf, *end = buf + len;
+
+	while (p < end) {
+		const char *eol = (const char *)memchr(p, '\n', end - p);
+		const char *space;
+		int t;
+
+		if (!eol)
+			eol = end;
+		space = (const char *)memchr(p, ' ', eol - p);
+		if (space && (t = table.find(p, space - p)) >= 0) {
+			const char *val = space + 1;
+
+			values[t - first] = next_unsigned(&val);
+		}
+		p = eol + 1;
+	}
+}
+
+int proc_cgroup_memory_parse (const char *buf, size_t len, uint64_t *memory)
+{
+	static const KeyTable table(CgroupMemory_anon, CgroupMemory_pgmajfault, 
+	                            strlen("CgroupMemory_"));
+
+	if (!memory)
+		return -1;
+
+	memset(memory, 0, sizeof(uint64_t) * CGROUP_MEMORY_FIELDS);
+	flat_keyed_parse(table, CgroupMemory_anon, buf, len, memory);
+	return 0;
+}
+
+int proc_cgroup_cpu_parse (const char *buf, size_t len, uint64_t *cpu)
+{
+	static const KeyTable table(CgroupCpu_usage_usec, CgroupCpu_throttled_usec, 
+	                            strlen("CgroupCpu_"));
+
+	if (!cpu)
+		return -1;
+
+	memset(cpu, 0, sizeof(uint64_t) * CGROUP_CPU_FIELDS);
+	flat_keyed_parse(table, CgroupCpu_usage_usec, buf, len, cpu);
+	return 0;
+}
+
+int proc_cgroup_io_parse (const char *buf, size_t len, uint64_t *io)
+{
+	static const KeyTable table(CgroupIO_rbytes, CgroupIO_dios, strlen("CgroupIO_"));
+	const char *p = buf, *end = buf + len;
+
+	if (!io)
+		return -1;
+
+	memset(io, 0, sizeof(uint64_t) * CGROUP_IO_FIELDS);
+
+	/** "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0", one line per device **/
+	while (p < end) {
+		const char *eol = (const char *)memchr(p, '\n', end - p);
+
+		if (!eol)
+			eol = end;
+		while ((p = (const char *)memchr(p, ' ', eol - p)) != NULL) {
+			const char *key = ++p;
+			const char *eq = (const char *)memchr(key, '=', eol - key);
+			int t;
+
+			if (!eq)
+				break;
+			p = eq + 1;
+			if ((t = table.find(key, eq - key)) >= 0)
+				io[t - CgroupIO_rbytes] += next_unsigned(&p);
+		}
+		p = eol + 1;
+	}
+
+	return 0;
+}
+
+/** the smaps trait names are the file's keys behind "Smaps" **/
+static const KeyTable &smaps_keys ()
+{
+	static const KeyTable table(SmapsRss, SmapsLocked, strlen("Smaps"));
+
+	return table;
+}
+
+int proc_smaps_parse (const char *buf, size_t len, uint64_t *smaps)
+{
+	const KeyTable &table = smaps_keys();
+
+	if (!smaps)
+		return -1;
+
+	memset(smaps, 0, sizeof(uint64_t) * SMAPS_FIELDS);
+
+	for_each_named_line(buf, len, [&](const char *key, size_t key_len, const char *val) {
+		const int t = table.find(key, key_len);
+
+		if (t >= 0)
+			smaps[t - SmapsRss] = next_unsigned(&val);
+		return true;
+	});
+
+	return 0;
+}
+
+static inline uint64_t next_hex (const char **pp)
+{
+	const char *p = *pp;
+	uint64_t v = 0;
+
+	for (;; p++) {
+		if ((unsigned)(*p - '0') < 10)
+			v = (v << 4) | (*p - '0');
+		else if ((unsigned)(*p - 'a') < 6)
+			v = (v << 4) | (*p - 'a' + 10);
+		else
+			break;
+	}
+
+	*pp = p;
+	return v;
+}
+
+int proc_smaps_header (const char *line, size_t len, struct SmapsMapping *map)
+{
+	const char *p = line, *end = line + len;
+	const char *space = (const char *)memchr(line, ' ', len);
+
+	/** "start-end perms offset dev inode   path", keys have a ':' first **/
+	if (!space || memchr(line, ':', space - line) || !memchr(line, '-', space - line))
+		return -1;
+
+	memset(map, 0, sizeof(struct SmapsMapping));
+	map->start = next_hex(&p);
+	p++;
+	map->end = next_hex(&p);
+	while (p < end && *p == ' ')
+		p++;
+	for (size_t i(0); i < sizeof(map->perms) - 1 && p < end && *p != ' '; i++)
+		map->perms[i] = *p++;
+	while (p < end && *p == ' ')
+		p++;
+	map->offset = next_hex(&p);
+
+	/** skip the device, major:minor **/
+	while (p < end && *p == ' ')
+		p++;
+	while (p < end && *p != ' ')
+		p++;
+	map->inode = next_unsigned(&p);
+	while (p < end && *p == ' ')
+		p++;
+
+	len = end - p < (ptrdiff_t)sizeof(map->path) ? end - p : sizeof(map->path) - 1;
+	memcpy(map->path, p, len);
+	map->path[len] = '\0';
+	return 0;
+}
+
+void proc_smaps_value (const char *line, size_t len, uint64_t *smaps)
+{
+	const char *sep = (const char *)memchr(line, ':', len);
+	int t;
+
+	if (sep && (t = smaps_keys().find(line, sep - line)) >= 0) {
+		const char *val = sep + 1;
+
+		smaps[t - SmapsRss] += next_unsigned(&val);
+	}
+}
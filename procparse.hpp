@@ -0,0 +1,296 @@
+/**
+ * procparse.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PROCPARSE_HPP_
+#define _PROCPARSE_HPP_  1
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "systeminfo.hpp"
+
+/**
+ * Parsers for the /proc text files the traits come from.  They
+ * all work on a buffer that has already been read and is NUL
+ * terminated at buf[len], so the same code serves the one-shot
+ * path in SystemInfo and the persistent fds in ProcReader.
+ */
+
+/** big enough for status/meminfo on hosts with long cpu masks **/
+#define PROC_BUFFER_SIZE 8192
+/** read buffers are kept on their own cache lines **/
+#define PROC_BUFFER_ALIGN 64
+
+/**
+ * proc_read_file - read all of path into buf (at most size - 1
+ * bytes) and NUL terminate it.
+ * @return  ssize_t - bytes read, -1 on failure
+ */
+ssize_t proc_read_file (const char *path, char *buf, size_t size);
+
+/**
+ * proc_read_fd - pread all of an already open /proc file from
+ * offset zero into buf (at most size - 1 bytes), NUL terminated.
+ * A seq_file regenerates its contents on a read at offset 0, so
+ * this is a complete refresh in one syscall.
+ * @return  ssize_t - bytes read, -1 on failure
+ */
+ssize_t proc_read_fd (const int fd, char *buf, size_t size);
+
+/** getdents64 buffer handed to proc_list_ids **/
+#define DIRENT_BUFFER_SIZE 32768
+
+/**
+ * proc_list_ids - read the numeric entries (pids or tids) of an
+ * open /proc directory into ids, sorted.
+ * @param dirent_buf - DIRENT_BUFFER_SIZE bytes of scratch
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_list_ids (const int dir_fd, char *dirent_buf, std::vector< int > &ids);
+
+/**
+ * proc_stat_parse - fill data from the text of /proc/<pid>/stat.
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_stat_parse (const char *buf, size_t len, struct ProcStatData *data);
+
+/**
+ * proc_stat_field - numeric value of a stat trait (pid1 through
+ * child_guest_time) widened to 64 bits; signed fields are stored
+ * two's complement, executable has no numeric value and gives 0.
+ */
+uint64_t proc_stat_field (const struct ProcStatData *data, const Trait trait);
+
+/**
+ * proc_status_parse - fill data from the text of /proc/<pid>/status
+ * in one pass; keys are matched exactly against the trait names.
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_status_parse (const char *buf, size_t len, struct ProcStatusData *data);
+
+/**
+ * proc_meminfo_parse - fill meminfo, indexed by trait - MemTotal,
+ * from the text of /proc/meminfo in one pass; keys are matched
+ * exactly against the trait names.
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_meminfo_parse (const char *buf, size_t len, uint64_t *meminfo);
+
+/**
+ * proc_io_parse - fill data from the text of /proc/<pid>/io in one
+ * pass; keys are matched exactly against the trait names.
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_io_parse (const char *buf, size_t len, struct ProcIOData *data);
+
+/**
+ * proc_pressure_parse - fill sample from the text of a PSI file,
+ * /proc/pressure/<resource> or a cgroup's <resource>.pressure.
+ * A missing full line leaves sample->full zeroed.
+ * @return  int - 0 on success, -1 if there was no some line
+ */
+int proc_pressure_parse (const char *buf, size_t len, struct PressureSample *sample);
+
+/**
+ * proc_cgroup_memory_parse - fill memory, indexed by trait -
+ * CgroupMemory_anon, from the "key value" lines of a cgroup's
+ * memory.stat; keys are the trait names without "CgroupMemory_".
+ * proc_cgroup_cpu_parse does the same for cpu.stat and the
+ * CgroupCpu_ traits.
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_cgroup_memory_parse (const char *buf, size_t len, uint64_t *memory);
+int proc_cgroup_cpu_parse (const char *buf, size_t len, uint64_t *cpu);
+
+/**
+ * proc_cgroup_io_parse - fill io, indexed by trait - CgroupIO_rbytes,
+ * with the "key=value" fields of a cgroup's io.stat summed over
+ * its per-device lines.
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_cgroup_io_parse (const char *buf, size_t len, uint64_t *io);
+
+/**
+ * proc_smaps_parse - fill smaps, indexed by trait - SmapsRss, from
+ * the text of /proc/<pid>/smaps_rollup in one pass; keys are
+ * matched exactly against the trait names without "Smaps".
+ * @return  int - 0 on success, -1 on failure
+ */
+int proc_smaps_parse (const char *buf, size_t len, uint64_t *smaps);
+
+/**
+ * SmapsMapping - one mapping of /proc/<pid>/smaps, its header line
+ * and its fields in kB indexed by trait - SmapsRss.  path is empty
+ * for anonymous mappings and cut at sizeof(path) - 1.
+ */
+struct SmapsMapping{
+   uint64_t start;
+   uint64_t end;
+   uint64_t offset;
+   uint64_t inode;
+   char     perms[5];
+   char     path[256];
+   uint64_t fields[SMAPS_FIELDS];
+};
+
+/**
+ * proc_smaps_header - if line is the header of a mapping (the
+ * address range line) fill map from it and zero its fields.
+ * @return  int - 0 if line was a header, -1 otherwise
+ */
+int proc_smaps_header (const char *line, size_t len, struct SmapsMapping *map);
+
+/**
+ * proc_smaps_value - add the "key: value kB" line to the field it
+ * names, lines for other keys are ignored.
+ */
+void proc_smaps_value (const char *line, size_t len, uint64_t *smaps);
+
+/**
+ * for_each_named_line - walk the "key: value" lines of buf and call
+ * fn(key, key_len, val) for each, val pointing past the separator
+ * and any leading blanks.  Nothing is copied; stops early when fn
+ * returns false.
+ */
+template <class Fn> void
+for_each_named_line (const char *buf, size_t len, Fn fn)
+{
+	const char *end = buf + len;
+
+	while (buf < end) {
+		const char *eol = (const char *)memchr(buf, '\n', end - buf);
+		const char *sep = (const char *)memchr(buf, ':', (eol ? eol : end) - buf);
+
+		if (sep) {
+			const char *val = sep + 1;
+
+			while (val < end && (*val == ' ' || *val == '\t'))
+				val++;
+			if (!fn(buf, (size_t)(sep - buf), val))
+				return;
+		}
+
+		if (!eol)
+			return;
+		buf = eol + 1;
+	}
+}
+
+/**
+ * for_each_line - stream path through buf, calling fn(line, len)
+ * for every line without its newline.  Only size bytes are ever
+ * held, so files such as numa_maps or smaps that can run to
+ * megabytes are never read whole; a line longer than the buffer
+ * is cut at size - 1 bytes.  Lines are NUL terminated in place.
+ * Stops early when fn returns false.
+ * @return  int - 0 on success, -1 if path can't be read
+ */
+template <class Fn> int
+for_each_line (const char *path, char *buf, const size_t size, Fn fn)
+{
+	size_t have = 0;
+	bool skip = false;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+		return -1;
+
+	for (;;) {
+		const ssize_t n = read(fd, buf + have, size - 1 - have);
+		char *line = buf, *eol, *end;
+
+		if (n < 0) {
+			close(fd);
+			return -1;
+		}
+		end = buf + have + n;
+
+		while ((eol = (char *)memchr(line, '\n', end - line)) != NULL) {
+			*eol = '\0';
+			/** tail of a line that was already cut **/
+			if (skip)
+				skip = false;
+			else if (!fn(line, (size_t)(eol - line)))
+				goto done;
+			line = eol + 1;
+		}
+		have = end - line;
+
+		if (n == 0) {
+			*end = '\0';
+			if (have > 0 && !skip)
+				fn(line, have);
+			break;
+		}
+		if (have == size - 1) {
+			*end = '\0';
+			if (!skip && !fn(line, have))
+				goto done;
+			have = 0;
+			skip = true;
+			continue;
+		}
+		memmove(buf, line, have);
+	}
+
+done:
+	close(fd);
+	return 0;
+}
+
+/**
+ * proc_smaps_for_each - stream /proc/<pid>/smaps through buf and
+ * call fn(const SmapsMapping &) once per mapping.  Like
+ * for_each_line only size bytes are held however many mappings
+ * the process has.  Stops early when fn returns false.
+ * @return  int - 0 on success, -1 if the file can't be read
+ */
+template <class Fn> int
+proc_smaps_for_each (const int pid, char *buf, const size_t size, Fn fn)
+{
+	struct SmapsMapping map, next;
+	char path[64];
+	bool have = false, more = true;
+
+	snprintf(path, sizeof(path), "/proc/%d/smaps", pid);
+	if (for_each_line(path, buf, size, [&](const char *line, size_t len) {
+		if (proc_smaps_header(line, len, &next) < 0) {
+			if (have)
+				proc_smaps_value(line, len, map.fields);
+			return true;
+		}
+		if (have && !(more = fn((const struct SmapsMapping &)map)))
+			return false;
+		map = next;
+		have = true;
+		return true;
+	}) < 0)
+		return -1;
+
+	if (have && more)
+		fn((const struct SmapsMapping &)map);
+	return 0;
+}
+
+#endif /* END _PROCPARSE_HPP_ */
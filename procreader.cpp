@@ -0,0 +1,245 @@
+/**
+ * procreader.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "procreader.hpp"
+#include "procparse.hpp"
+
+ProcReader::ProcReader() : pid( -1 ),
+                           stat_fd( -1 ),
+                           status_fd( -1 ),
+                           meminfo_fd( -1 ),
+                           smaps_fd( -1 ),
+                           io_fd( -1 ),
+                           buf( NULL ),
+                           sample_cpus( false )
+{
+	void *ptr = NULL;
+
+	for (int r(0); r < PRESSURE_RESOURCES; r++)
+		pressure_fds[r] = cgroup_pressure_fds[r] = -1;
+	for (int f(0); f < CGROUP_FILES; f++)
+		cgroup_fds[f] = -1;
+
+	/** open() refuses to start without it **/
+	if (posix_memalign(&ptr, PROC_BUFFER_ALIGN, PROC_BUFFER_SIZE) != 0)
+		perror("Failed to allocate proc buffer");
+	else
+		buf = (char *)ptr;
+}
+
+ProcReader::~ProcReader()
+{
+	close();
+	free(buf);
+}
+
+int
+ProcReader::open (const int pid, const uint32_t sources)
+{
+	const uint32_t stat_sources = (1u << SourceStat) | (1u << SourceNuma) | 
+	                              (1u << SourceCpu);
+	char path[64];
+	bool failed = false;
+
+	close();
+	if (!buf)
+		return -1;
+	this->pid = pid;
+
+	if (sources & stat_sources) {
+		snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+		failed |= (stat_fd = ::open(path, O_RDONLY | O_CLOEXEC)) < 0;
+	}
+
+	if (sources & (1u << SourceStatus)) {
+		snprintf(path, sizeof(path), "/proc/%d/status", pid);
+		failed |= (status_fd = ::open(path, O_RDONLY | O_CLOEXEC)) < 0;
+	}
+
+	if (sources & (1u << SourceMeminfo))
+		failed |= (meminfo_fd = ::open("/proc/meminfo", O_RDONLY | O_CLOEXEC)) < 0;
+
+	sample_cpus = (sources & (1u << SourceCpu)) != 0;
+
+	if (failed) {
+		close();
+		return -1;
+	}
+
+	/** not an error, the Perf* traits are just unavailable **/
+	if (sources & (1u << SourcePerf))
+		perf.open(pid);
+	/** nor is this, other users' processes need CAP_SYS_PTRACE **/
+	if (sources & (1u << SourceSmaps)) {
+		snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+		smaps_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	}
+	if (sources & (1u << SourceIO)) {
+		snprintf(path, sizeof(path), "/proc/%d/io", pid);
+		io_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	}
+	if (sources & (1u << SourcePressure))
+		pressure_open(PRESSURE_HOST_DIR, pressure_fds);
+	if (sources & ((1u << SourceCgroupPressure) | (1u << SourceCgroup))) {
+		char dir[PATH_MAX];
+
+		/** the pid stays in this cgroup unless it is moved **/
+		if (cgroup_dir(pid, dir, sizeof(dir)) == 0) {
+			if (sources & (1u << SourceCgroupPressure))
+				pressure_open(dir, cgroup_pressure_fds);
+			if (sources & (1u << SourceCgroup))
+				cgroup_open(dir, cgroup_fds);
+		}
+	}
+	return 0;
+}
+
+void
+ProcReader::close ()
+{
+	if (stat_fd >= 0)
+		::close(stat_fd);
+	if (status_fd >= 0)
+		::close(status_fd);
+	if (meminfo_fd >= 0)
+		::close(meminfo_fd);
+	if (smaps_fd >= 0)
+		::close(smaps_fd);
+	if (io_fd >= 0)
+		::close(io_fd);
+
+	for (int r(0); r < PRESSURE_RESOURCES; r++) {
+		if (pressure_fds[r] >= 0)
+			::close(pressure_fds[r]);
+		if (cgroup_pressure_fds[r] >= 0)
+			::close(cgroup_pressure_fds[r]);
+		pressure_fds[r] = cgroup_pressure_fds[r] = -1;
+	}
+	for (int f(0); f < CGROUP_FILES; f++) {
+		if (cgroup_fds[f] >= 0)
+			::close(cgroup_fds[f]);
+		cgroup_fds[f] = -1;
+	}
+
+	stat_fd = status_fd = meminfo_fd = smaps_fd = io_fd = -1;
+	sample_cpus = false;
+	perf.close();
+}
+
+ssize_t
+ProcReader::refresh (const int fd)
+{
+	return proc_read_fd(fd, buf, PROC_BUFFER_SIZE);
+}
+
+int
+ProcReader::readStat (struct ProcStatData *data)
+{
+	ssize_t len = refresh(stat_fd);
+
+	if (len < 0)
+		return -1;
+	return proc_stat_parse(buf, len, data);
+}
+
+int
+ProcReader::readStatus (struct ProcStatusData *data)
+{
+	ssize_t len = refresh(status_fd);
+
+	if (len < 0)
+		return -1;
+	return proc_status_parse(buf, len, data);
+}
+
+int
+ProcReader::readMeminfo (uint64_t *meminfo)
+{
+	ssize_t len = refresh(meminfo_fd);
+
+	if (len < 0)
+		return -1;
+	return proc_meminfo_parse(buf, len, meminfo);
+}
+
+int
+ProcReader::readPerf (struct PerfSample *sample)
+{
+	return perf.read(sample);
+}
+
+int
+ProcReader::readSmaps (uint64_t *smaps)
+{
+	ssize_t len = refresh(smaps_fd);
+
+	if (len < 0)
+		return -1;
+	return proc_smaps_parse(buf, len, smaps);
+}
+
+int
+ProcReader::readIO (struct ProcIOData *data)
+{
+	ssize_t len = refresh(io_fd);
+
+	if (len < 0)
+		return -1;
+	return proc_io_parse(buf, len, data);
+}
+
+int
+ProcReader::readPressure (struct PressureSample samples[PRESSURE_RESOURCES])
+{
+	return pressure_read(pressure_fds, buf, PROC_BUFFER_SIZE, samples);
+}
+
+int
+ProcReader::readCgroupPressure (struct PressureSample samples[PRESSURE_RESOURCES])
+{
+	return pressure_read(cgroup_pressure_fds, buf, PROC_BUFFER_SIZE, samples);
+}
+
+int
+ProcReader::readCgroup (struct CgroupSample *sample)
+{
+	return cgroup_read(cgroup_fds, buf, PROC_BUFFER_SIZE, sample);
+}
+
+int
+ProcReader::readCpu (const int cpu, struct CpuSample *sample)
+{
+	if (!sample_cpus || cpu_sampler.sample() < 0)
+		return -1;
+
+	for (size_t i(0); i < cpu_sampler.size(); i++) {
+		if (cpu_sampler.samples()[i].cpu == cpu) {
+			*sample = cpu_sampler.samples()[i];
+			return 0;
+		}
+	}
+	return -1;
+}
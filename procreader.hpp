@@ -0,0 +1,117 @@
+/**
+ * procreader.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PROCREADER_HPP_
+#define _PROCREADER_HPP_  1
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "systeminfo.hpp"
+#include "perfcounters.hpp"
+#include "pressure.hpp"
+#include "cgroup.hpp"
+#include "cpustat.hpp"
+
+/**
+ * ProcReader - keeps /proc/<pid>/stat, /proc/<pid>/status and
+ * /proc/meminfo open between samples and refreshes them with a
+ * single pread at offset zero into one reusable, cache aligned
+ * buffer.  After open() a refresh costs one syscall per source
+ * and no allocations.  Every read* call returns -1 once the
+ * process has gone away.  Asked for SourcePerf, open() also
+ * starts PerfCounters groups on the pid's threads for the Perf*
+ * traits, when perf allows it.  It opens smaps_rollup and io, which need ptrace access to the
+ * pid, the host's and the pid's cgroup's PSI files and the
+ * cgroup's accounting files.  For SourceCpu every online cpu is
+ * sampled through a CpuSampler, which keeps the cpufreq files
+ * open and the previous pass for per cpu usage.
+ */
+class ProcReader
+{
+public:
+   ProcReader();
+   ~ProcReader();
+
+   ProcReader( const ProcReader &other )              = delete;
+   ProcReader &operator = ( const ProcReader &other ) = delete;
+
+   /**
+    * open - open the per-process and host wide files for pid,
+    * closing whatever was open before.  Only the files of the
+    * Sources in sources are opened (stat also for SourceNuma and
+    * SourceCpu); reading a source that wasn't opened fails.
+    * Perf, smaps_rollup, io, PSI and cgroup files failing to open
+    * is not an error, only their traits are unavailable.
+    * @param pid - process to sample
+    * @param sources - bit mask of Sources, see TraitSet::sources
+    * @return  int - 0 on success, -1 on failure
+    */
+   int open (const int pid, const uint32_t sources = SOURCE_DEFAULT);
+
+   /**
+    * close - release all fds, safe to call more than once.
+    */
+   void close ();
+
+   int getPid () const { return pid; }
+
+   int readStat (struct ProcStatData *data);
+   int readStatus (struct ProcStatusData *data);
+   int readMeminfo (uint64_t *meminfo);
+   int readPerf (struct PerfSample *sample);
+   int readSmaps (uint64_t *smaps);
+   int readIO (struct ProcIOData *data);
+   int readPressure (struct PressureSample samples[PRESSURE_RESOURCES]);
+   int readCgroupPressure (struct PressureSample samples[PRESSURE_RESOURCES]);
+   int readCgroup (struct CgroupSample *sample);
+
+   /**
+    * readCpu - sample every online cpu and copy out cpu's sample.
+    * @return  int - 0 on success, -1 if cpu is offline or SourceCpu
+    *          wasn't opened
+    */
+   int readCpu (const int cpu, struct CpuSample *sample);
+
+   /** cpus - the per cpu passes readCpu took **/
+   const CpuSampler &cpus () const { return cpu_sampler; }
+
+private:
+   /**
+    * refresh - pread the whole of fd into buf, NUL terminated.
+    * @return  ssize_t - bytes read, -1 on failure
+    */
+   ssize_t refresh (const int fd);
+
+   int    pid;
+   int    stat_fd;
+   int    status_fd;
+   int    meminfo_fd;
+   int    smaps_fd;
+   int    io_fd;
+   int    pressure_fds[PRESSURE_RESOURCES];
+   int    cgroup_pressure_fds[PRESSURE_RESOURCES];
+   int    cgroup_fds[CGROUP_FILES];
+   char  *buf;
+   bool   sample_cpus;
+   PerfCounters perf;
+   CpuSampler   cpu_sampler;
+};
+
+#endif /* END _PROCREADER_HPP_ */
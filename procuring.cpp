@@ -0,0 +1,290 @@
+/**
+ * procuring.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "procuring.hpp"
+#include "procparse.hpp"
+
+static int uring_setup (const unsigned entries, struct io_uring_params *p)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter (const int fd, const unsigned to_submit, 
+                        const unsigned min_complete, const unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, 
+	                    flags, NULL, 0);
+}
+
+ProcUring::ProcUring() : ring_fd( -1 ),
+                         depth( 0 ),
+                         slot_size( 0 ),
+                         slots( NULL ),
+                         sq_ptr( MAP_FAILED ),
+                         sq_size( 0 ),
+                         cq_ptr( MAP_FAILED ),
+                         cq_size( 0 ),
+                         sqes( MAP_FAILED ),
+                         sqes_size( 0 ),
+                         sq_head( NULL ),
+                         sq_tail( NULL ),
+                         sq_mask( NULL ),
+                         sq_array( NULL ),
+                         cq_head( NULL ),
+                         cq_tail( NULL ),
+                         cq_mask( NULL ),
+                         cqes( NULL ),
+                         syscall_count( 0 )
+{
+}
+
+ProcUring::~ProcUring()
+{
+	close();
+}
+
+int
+ProcUring::open (const size_t slot_size)
+{
+	struct io_uring_params p;
+	void *ptr = NULL;
+
+	close();
+
+	/** the pread fallback needs one slot too **/
+	if (posix_memalign(&ptr, PROC_BUFFER_ALIGN, URING_DEPTH * slot_size) != 0) {
+		perror("Failed to allocate uring slots");
+		return -1;
+	}
+	slots = (char *)ptr;
+	this->slot_size = slot_size;
+
+	memset(&p, 0, sizeof(p));
+	if ((ring_fd = uring_setup(URING_DEPTH, &p)) < 0)
+		return -1;
+	depth = p.sq_entries;
+
+	sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (cq_size > sq_size)
+			sq_size = cq_size;
+		cq_size = 0;
+	}
+
+	sq_ptr = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, 
+	              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if (sq_ptr == MAP_FAILED)
+		goto fail;
+
+	if (cq_size) {
+		cq_ptr = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, 
+		              MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if (cq_ptr == MAP_FAILED)
+			goto fail;
+	}
+
+	sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+	sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, 
+	            MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+		goto fail;
+
+	{
+		char *sq = (char *)sq_ptr;
+		char *cq = cq_size ? (char *)cq_ptr : sq;
+
+		sq_head = (unsigned *)(sq + p.sq_off.head);
+		sq_tail = (unsigned *)(sq + p.sq_off.tail);
+		sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+		sq_array = (unsigned *)(sq + p.sq_off.array);
+		cq_head = (unsigned *)(cq + p.cq_off.head);
+		cq_tail = (unsigned *)(cq + p.cq_off.tail);
+		cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+		cqes = cq + p.cq_off.cqes;
+	}
+	return 0;
+
+fail:
+	perror("Failed to map io_uring");
+	/** keep the slots for the fallback **/
+	closeRing();
+	return -1;
+}
+
+void
+ProcUring::close ()
+{
+	closeRing();
+	free(slots);
+	slots = NULL;
+}
+
+void
+ProcUring::closeRing ()
+{
+	if (sqes != MAP_FAILED)
+		munmap(sqes, sqes_size);
+	if (cq_ptr != MAP_FAILED)
+		munmap(cq_ptr, cq_size);
+	if (sq_ptr != MAP_FAILED)
+		munmap(sq_ptr, sq_size);
+	sqes = cq_ptr = sq_ptr = MAP_FAILED;
+
+	if (ring_fd >= 0)
+		::close(ring_fd);
+	ring_fd = -1;
+}
+
+int
+ProcUring::readBatch (const int *fds, const size_t base, const size_t count,
+                      const std::function< void (size_t, char *, ssize_t) > &fn)
+{
+	struct io_uring_sqe *sqe = (struct io_uring_sqe *)sqes;
+	struct io_uring_cqe *cqe = (struct io_uring_cqe *)cqes;
+	const unsigned start = *sq_tail;
+	unsigned tail = start, queued = 0, submitted = 0, reaped = 0, head;
+
+	for (size_t i(0); i < count; i++) {
+		const unsigned idx = tail & *sq_mask;
+
+		if (fds[base + i] < 0) {
+			fn(base + i, &slots[i * slot_size], -1);
+			continue;
+		}
+
+		memset(&sqe[idx], 0, sizeof(struct io_uring_sqe));
+		sqe[idx].opcode = IORING_OP_READ;
+		sqe[idx].fd = fds[base + i];
+		sqe[idx].off = 0;
+		sqe[idx].addr = (uint64_t)(uintptr_t)&slots[i * slot_size];
+		sqe[idx].len = slot_size - 1;
+		sqe[idx].user_data = i;
+		sq_array[idx] = idx;
+		tail++;
+		queued++;
+	}
+	if (queued == 0)
+		return 0;
+
+	/** the kernel may only read the tail after the entries are written **/
+	__atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+	/** normally one pass: submit everything and wait for all of it **/
+	while (reaped < queued) {
+		int ret;
+
+		syscall_count++;
+		ret = uring_enter(ring_fd, queued - submitted, queued - reaped, 
+		                  IORING_ENTER_GETEVENTS);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("io_uring_enter");
+			abandon(start, reaped);
+			return -1;
+		}
+		submitted += ret;
+
+		head = *cq_head;
+		while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+			const struct io_uring_cqe *c = &cqe[head & *cq_mask];
+			const size_t i = (size_t)c->user_data;
+			char *buf = &slots[i * slot_size];
+			ssize_t len = -1;
+
+			if (c->res > 0) {
+				len = c->res;
+				buf[len] = '\0';
+			}
+			fn(base + i, buf, len);
+			head++;
+			reaped++;
+		}
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	}
+	return 0;
+}
+
+/**
+ * abandon - leave the ring empty after a failed batch, so the next
+ * batch's user_data indices can't be matched with completions of
+ * this one.  Entries the kernel never consumed are taken back and
+ * the reads already submitted are waited for and dropped.  If even
+ * that fails the ring is torn down and reads fall back to pread.
+ */
+void
+ProcUring::abandon (const unsigned start, const unsigned reaped)
+{
+	const unsigned consumed = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+	unsigned inflight = (consumed - start) - reaped;
+
+	/** without SQPOLL the tail is ours and the kernel stopped at head **/
+	__atomic_store_n(sq_tail, consumed, __ATOMIC_RELEASE);
+
+	while (inflight > 0) {
+		unsigned head;
+
+		syscall_count++;
+		if (uring_enter(ring_fd, 0, inflight, IORING_ENTER_GETEVENTS) < 0 && 
+		    errno != EINTR) {
+			closeRing();
+			return;
+		}
+		head = *cq_head;
+		while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) && inflight > 0) {
+			head++;
+			inflight--;
+		}
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	}
+}
+
+int
+ProcUring::read (const int *fds, const size_t count,
+                 const std::function< void (size_t, char *, ssize_t) > &fn)
+{
+	if (!slots)
+		return -1;
+
+	if (ring_fd < 0) {
+		for (size_t i(0); i < count; i++) {
+			syscall_count += (fds[i] >= 0);
+			fn(i, slots, proc_read_fd(fds[i], slots, slot_size));
+		}
+		return 0;
+	}
+
+	for (size_t base(0); base < count; base += depth) {
+		const size_t n = count - base < depth ? count - base : depth;
+
+		if (readBatch(fds, base, n, fn) < 0)
+			return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * procuring.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _PROCURING_HPP_
+#define _PROCURING_HPP_  1
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <sys/types.h>
+
+/** reads in flight per io_uring_enter **/
+#define URING_DEPTH 256
+
+/**
+ * ProcUring - batched offset zero reads of many already open /proc
+ * fds through io_uring, using the raw syscalls so there is no
+ * library dependency.  read() queues up to URING_DEPTH reads, one
+ * per fd, submits and reaps them with a single io_uring_enter and
+ * hands each result to the callback, so a pass over n fds costs
+ * about n / URING_DEPTH syscalls instead of n.  When io_uring is
+ * unavailable (old kernel, seccomp, io_uring_disabled) open()
+ * fails and read() falls back to one pread per fd with the same
+ * results, so callers don't need a second code path.
+ */
+class ProcUring
+{
+public:
+   ProcUring();
+   ~ProcUring();
+
+   ProcUring( const ProcUring &other )              = delete;
+   ProcUring &operator = ( const ProcUring &other ) = delete;
+
+   /**
+    * open - set up the ring and slot_size bytes of buffer per slot.
+    * @param slot_size - largest file expected, e.g. PROC_BUFFER_SIZE
+    * @return  int - 0 on success, -1 if io_uring is unavailable
+    */
+   int open (const size_t slot_size);
+
+   void close ();
+
+   bool isOpen () const { return ring_fd >= 0; }
+
+   /**
+    * read - read every fd in fds at offset 0.  fn(index, buf, len)
+    * is called once per fd, in completion order, with the data NUL
+    * terminated in buf; len is -1 if the read failed or the fd was
+    * negative.  buf is only valid during the call.
+    * @return  int - 0 on success, -1 if the ring itself failed; fn
+    * may then not have been called for every fd
+    */
+   int read (const int *fds, const size_t count,
+             const std::function< void (size_t, char *, ssize_t) > &fn);
+
+   /** syscalls - reads issued so far, io_uring_enter or pread **/
+   uint64_t syscalls () const { return syscall_count; }
+
+private:
+   void closeRing ();
+   void abandon (const unsigned start, const unsigned reaped);
+   int readBatch (const int *fds, const size_t base, const size_t count,
+                  const std::function< void (size_t, char *, ssize_t) > &fn);
+
+   int        ring_fd;
+   unsigned   depth;
+   size_t     slot_size;
+   char      *slots;
+   /** mmapped rings, laid out as io_uring_params describes **/
+   void      *sq_ptr;
+   size_t     sq_size;
+   void      *cq_ptr;
+   size_t     cq_size;
+   void      *sqes;
+   size_t     sqes_size;
+   unsigned  *sq_head;
+   unsigned  *sq_tail;
+   unsigned  *sq_mask;
+   unsigned  *sq_array;
+   unsigned  *cq_head;
+   unsigned  *cq_tail;
+   unsigned  *cq_mask;
+   void      *cqes;
+   uint64_t   syscall_count;
+};
+
+#endif /* END _PROCURING_HPP_ */
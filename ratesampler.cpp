@@ -0,0 +1,183 @@
+/**
+ * ratesampler.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+#include <climits>
+#include <unistd.h>
+#if __linux
+#include <sys/sysinfo.h>
+#endif
+
+#include "ratesampler.hpp"
+
+/** width in bits of a counter field, for counter_delta **/
+#define FIELD_BITS(field) ((unsigned)(sizeof(field) * CHAR_BIT))
+
+uint64_t counter_delta (const uint64_t prev, const uint64_t curr, const unsigned bits)
+{
+	if (curr >= prev)
+		return curr - prev;
+	if (bits < 64)
+		return ((1ULL << bits) - prev) + curr;
+	return 0;
+}
+
+static inline double rate (const uint64_t prev, const uint64_t curr, 
+                           const unsigned bits, const double seconds)
+{
+	return counter_delta(prev, curr, bits) / seconds;
+}
+
+RateSampler::RateSampler() : have_prev( false ),
+                             prev_timestamp( 0 ),
+                             ticks_per_second( sysconf(_SC_CLK_TCK) ),
+                             processors( 1 )
+{
+	memset(&prev_stat, 0, sizeof(prev_stat));
+	memset(&prev_status, 0, sizeof(prev_status));
+	memset(&prev_io, 0, sizeof(prev_io));
+	memset(&prev_cgroup, 0, sizeof(prev_cgroup));
+#if __linux
+	processors = get_nprocs();
+#endif
+	if (ticks_per_second <= 0)
+		ticks_per_second = 100;
+	if (processors <= 0)
+		processors = 1;
+}
+
+int
+RateSampler::sample (const struct ProcStatData *stat,
+                     const struct ProcStatusData *status,
+                     const struct ProcIOData *io,
+                     const uint64_t timestamp,
+                     struct ProcRates *rates)
+{
+	struct ProcStatusData no_status;
+	struct ProcIOData no_io;
+
+	if (!stat || !rates)
+		return -1;
+
+	memset(rates, 0, sizeof(struct ProcRates));
+	if (!status) {
+		memset(&no_status, 0, sizeof(no_status));
+		status = &no_status;
+	}
+	if (!io) {
+		memset(&no_io, 0, sizeof(no_io));
+		io = &no_io;
+	}
+
+	/** same pid but a different start time is a new process **/
+	if (have_prev && 
+	    (stat->pid != prev_stat.pid || 
+	     stat->start_time != prev_stat.start_time ||
+	     timestamp <= prev_timestamp))
+		have_prev = false;
+
+	if (have_prev) {
+		const double seconds = (timestamp - prev_timestamp) * 1e-9;
+		const double ticks = (double)ticks_per_second;
+
+		rates->valid = true;
+		rates->interval = seconds;
+		rates->minor_faults = rate(prev_stat.minor_faults, stat->minor_faults, 
+		                           FIELD_BITS(stat->minor_faults), seconds);
+		rates->major_faults = rate(prev_stat.major_faults, stat->major_faults, 
+		                           FIELD_BITS(stat->major_faults), seconds);
+		rates->user_time = rate(prev_stat.uptime, stat->uptime, 
+		                        FIELD_BITS(stat->uptime), seconds);
+		rates->scheduled_time = rate(prev_stat.scheduled_time, stat->scheduled_time, 
+		                             FIELD_BITS(stat->scheduled_time), seconds);
+		rates->delayed_io_ticks = rate(prev_stat.delayed_io_ticks, stat->delayed_io_ticks, 
+		                               FIELD_BITS(stat->delayed_io_ticks), seconds);
+		rates->guest_time = rate(prev_stat.guest_time, stat->guest_time, 
+		                         FIELD_BITS(stat->guest_time), seconds);
+		rates->voluntary_ctxt_switches = 
+			rate((unsigned)prev_status.voluntary_context_swaps, 
+			     (unsigned)status->voluntary_context_swaps,
+			     FIELD_BITS(status->voluntary_context_swaps), seconds);
+		rates->nonvoluntary_ctxt_switches = 
+			rate((unsigned)prev_status.non_voluntary_context_swaps,
+			     (unsigned)status->non_voluntary_context_swaps,
+			     FIELD_BITS(status->non_voluntary_context_swaps), seconds);
+		rates->rchar = rate(prev_io.rchar, io->rchar, FIELD_BITS(io->rchar), seconds);
+		rates->wchar = rate(prev_io.wchar, io->wchar, FIELD_BITS(io->wchar), seconds);
+		rates->syscr = rate(prev_io.syscr, io->syscr, FIELD_BITS(io->syscr), seconds);
+		rates->syscw = rate(prev_io.syscw, io->syscw, FIELD_BITS(io->syscw), seconds);
+		rates->read_bytes = rate(prev_io.read_bytes, io->read_bytes, 
+		                         FIELD_BITS(io->read_bytes), seconds);
+		rates->write_bytes = rate(prev_io.write_bytes, io->write_bytes, 
+		                          FIELD_BITS(io->write_bytes), seconds);
+		rates->cancelled_write_bytes = 
+			rate(prev_io.cancelled_write_bytes, io->cancelled_write_bytes,
+			     FIELD_BITS(io->cancelled_write_bytes), seconds);
+
+		rates->cpu_percent = 
+			(rates->user_time + rates->scheduled_time) / ticks * 100.0;
+		rates->host_cpu_percent = rates->cpu_percent / processors;
+	}
+
+	prev_stat = *stat;
+	prev_status = *status;
+	prev_io = *io;
+	prev_timestamp = timestamp;
+	have_prev = true;
+
+	return 0;
+}
+
+#if __linux
+int
+RateSampler::sample (const struct SystemSnapshot *snap, struct ProcRates *rates)
+{
+	const uint64_t prev = prev_timestamp;
+	const bool had_prev = have_prev;
+
+	if (!snap)
+		return -1;
+
+	const struct CgroupSample *cgroup = &snap->cgroup;
+	if (snap->number_processors > 0)
+		processors = snap->number_processors;
+	if (sample(&snap->stat, &snap->status, &snap->io, snap->timestamp, rates) < 0)
+		return -1;
+
+	if (had_prev && snap->timestamp > prev && 
+	    cgroup->cpu[0] >= prev_cgroup.cpu[0]) {
+		const double seconds = (snap->timestamp - prev) * 1e-9;
+		const int throttled = CgroupCpu_throttled_usec - CgroupCpu_usage_usec,
+		          nr_throttled = CgroupCpu_nr_throttled - CgroupCpu_usage_usec;
+
+		rates->cgroup_cpu_percent = 
+			rate(prev_cgroup.cpu[0], cgroup->cpu[0], 64, seconds) / 1e4;
+		rates->cgroup_throttled_percent = 
+			rate(prev_cgroup.cpu[throttled], cgroup->cpu[throttled], 64, seconds) / 1e4;
+		rates->cgroup_nr_throttled = 
+			rate(prev_cgroup.cpu[nr_throttled], cgroup->cpu[nr_throttled], 64, seconds);
+		rates->cgroup_rbytes = rate(prev_cgroup.io[0], cgroup->io[0], 64, seconds);
+		rates->cgroup_wbytes = rate(prev_cgroup.io[CgroupIO_wbytes - CgroupIO_rbytes], 
+		                            cgroup->io[CgroupIO_wbytes - CgroupIO_rbytes], 
+		                            64, seconds);
+	}
+	prev_cgroup = *cgroup;
+	return 0;
+}
+#endif
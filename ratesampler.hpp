@@ -0,0 +1,130 @@
+/**
+ * ratesampler.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _RATESAMPLER_HPP_
+#define _RATESAMPLER_HPP_  1
+#include <cstdint>
+
+#include "systeminfo.hpp"
+
+/**
+ * ProcRates - per second rates of the monotonic per-process
+ * counters between two samples.  Times are in clock ticks per
+ * second; cpu_percent is relative to one cpu (up to 100 *
+ * processors) and host_cpu_percent to the whole host (0..100).
+ * valid is false on the first sample and whenever the baseline
+ * had to be reset (pid reused, counters went backwards).
+ */
+struct ProcRates{
+   bool   valid;
+   double interval;                  /* seconds between the samples */
+   double minor_faults;
+   double major_faults;
+   double user_time;                 /* ProcStatData::uptime, utime in ticks */
+   double scheduled_time;            /* ProcStatData::scheduled_time, stime in ticks */
+   double delayed_io_ticks;
+   double guest_time;
+   double voluntary_ctxt_switches;
+   double nonvoluntary_ctxt_switches;
+   double rchar;                     /* bytes */
+   double wchar;                     /* bytes */
+   double syscr;
+   double syscw;
+   double read_bytes;                /* bytes sent to the block layer */
+   double write_bytes;               /* bytes sent to the block layer */
+   double cancelled_write_bytes;
+   double cpu_percent;
+   double host_cpu_percent;
+   /** of the pid's cgroup, only from snapshots with SourceCgroup **/
+   double cgroup_cpu_percent;        /* usage_usec, relative to one cpu */
+   double cgroup_throttled_percent;  /* share of the interval spent throttled */
+   double cgroup_nr_throttled;       /* periods throttled */
+   double cgroup_rbytes;
+   double cgroup_wbytes;
+};
+
+/**
+ * counter_delta - difference of a monotonic counter that is bits
+ * wide.  A counter narrower than 64 bits that went backwards is
+ * taken to have wrapped once; a 64 bit counter that went backwards
+ * has been reset and gives 0.
+ */
+uint64_t counter_delta (const uint64_t prev, const uint64_t curr, const unsigned bits);
+
+/**
+ * RateSampler - keeps the previous sample of one process and
+ * turns each new sample into rates.  A change of pid or of
+ * start_time means the pid now belongs to a different process,
+ * so the baseline is reset instead of producing a bogus delta.
+ */
+class RateSampler
+{
+public:
+   RateSampler();
+
+   /**
+    * sample - rates between the previous sample and this one.
+    * @param stat - stat data of the process
+    * @param status - status data of the process, may be NULL
+    * @param io - io data of the process, may be NULL
+    * @param timestamp - CLOCK_MONOTONIC ns the data was read at
+    * @param rates - filled in, rates->valid false on a new baseline
+    * @return  int - 0 on success, -1 on bad arguments
+    */
+   int sample (const struct ProcStatData *stat,
+               const struct ProcStatusData *status,
+               const struct ProcIOData *io,
+               const uint64_t timestamp,
+               struct ProcRates *rates);
+
+   int sample (const struct ProcStatData *stat,
+               const struct ProcStatusData *status,
+               const uint64_t timestamp,
+               struct ProcRates *rates)
+   {
+      return( sample( stat, status, nullptr, timestamp, rates ) );
+   }
+
+#if __linux
+   /**
+    * sample - same as above using the stat, status, io and
+    * timestamp of a snapshot, plus the cgroup rates.  The cgroup
+    * counters outlive any one pid, so they only start over when
+    * they go backwards (the pid moved to another cgroup).
+    */
+   int sample (const struct SystemSnapshot *snap, struct ProcRates *rates);
+#endif
+
+   /**
+    * reset - forget the previous sample.
+    */
+   void reset () { have_prev = false; }
+
+private:
+   bool                  have_prev;
+   uint64_t              prev_timestamp;
+   struct ProcStatData   prev_stat;
+   struct ProcStatusData prev_status;
+   struct ProcIOData     prev_io;
+   struct CgroupSample   prev_cgroup;
+   long                  ticks_per_second;
+   int                   processors;
+};
+
+#endif /* END _RATESAMPLER_HPP_ */
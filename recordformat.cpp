@@ -0,0 +1,449 @@
+/**
+ * recordformat.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "recordformat.hpp"
+
+#define HEADER_FIXED_SIZE 24
+
+static inline void put_le (std::vector< uint8_t > &out, uint64_t v, const int bytes)
+{
+	for (int b(0); b < bytes; b++, v >>= 8)
+		out.push_back((uint8_t)v);
+}
+
+static inline uint64_t get_le (const uint8_t *p, const int bytes)
+{
+	uint64_t v = 0;
+
+	for (int b(bytes - 1); b >= 0; b--)
+		v = (v << 8) | p[b];
+	return v;
+}
+
+static inline void put_varint (std::vector< uint8_t > &out, uint64_t v)
+{
+	while (v >= 0x80) {
+		out.push_back((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back((uint8_t)v);
+}
+
+/** @return  bool - false if the varint runs past end **/
+static inline bool get_varint (const uint8_t **pp, const uint8_t *end, uint64_t *v)
+{
+	const uint8_t *p = *pp;
+	unsigned shift = 0;
+
+	*v = 0;
+	while (p < end && shift < 64) {
+		*v |= (uint64_t)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80)) {
+			*pp = p;
+			return true;
+		}
+		shift += 7;
+	}
+	return false;
+}
+
+/** zigzag - signed deltas to small unsigned numbers, -1 -> 1, 1 -> 2 **/
+static inline uint64_t zigzag (const int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag (const uint64_t v)
+{
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline size_t bitmap_words (const size_t fields)
+{
+	return (fields + 63) / 64;
+}
+
+/**
+ * probe_type - type getSnapshotValue gives trait when its source
+ * is available; a zeroed snapshot with every perf slot marked
+ * available (and non-zero cycles for PerfIPC) reaches the typed
+ * branch of every trait.
+ */
+static TraitValue probe_type (const Trait trait)
+{
+	static const struct SystemSnapshot *probe = []() {
+		static struct SystemSnapshot snap;
+
+		memset(&snap, 0, sizeof(snap));
+		snap.perf.hardware = true;
+		snap.perf.count[0] = 1;
+		for (int i(0); i < PERF_TRAITS; i++)
+			snap.perf.available[i] = true;
+		return &snap;
+	}();
+
+	return SystemInfo::getSnapshotValue(trait, probe);
+}
+
+static uint64_t value_bits (const TraitValue &v)
+{
+	uint64_t bits = 0;
+
+	if (v.type == TypeDouble)
+		memcpy(&bits, &v.d, sizeof(bits));
+	else if (v.type == TypeSigned)
+		bits = (uint64_t)v.i;
+	else
+		bits = v.u;
+	return bits;
+}
+
+RecordWriter::RecordWriter() : out( NULL ),
+                               flags( 0 ),
+                               prev_timestamp( 0 ),
+                               prev_pid( 0 )
+{
+}
+
+std::vector< Trait >
+RecordWriter::recordable ()
+{
+	std::vector< Trait > traits;
+
+	for (int t(0); t < N; t++) {
+		const ValueType type = probe_type((Trait)t).type;
+
+		if (type != TypeString && type != TypeNone)
+			traits.push_back((Trait)t);
+	}
+	return traits;
+}
+
+int
+RecordWriter::open (FILE *out, const std::vector< Trait > &traits, const unsigned flags)
+{
+	std::vector< uint8_t > header;
+	size_t words = bitmap_words(traits.size());
+
+	/** write() stays refused until the header is out **/
+	this->out = NULL;
+	this->flags = flags;
+	this->traits = traits;
+	types.clear();
+	prev.assign(traits.size(), 0);
+	prev_timestamp = 0;
+	prev_pid = 0;
+
+	if (!out || traits.size() > UINT16_MAX)
+		return -1;
+
+	header.insert(header.end(), RECORD_MAGIC, RECORD_MAGIC + sizeof(RECORD_MAGIC));
+	put_le(header, RECORD_VERSION, 2);
+	put_le(header, flags, 2);
+	put_le(header, traits.size(), 2);
+	put_le(header, 0, 4); /* header_size, patched below */
+	put_le(header, flags & RECORD_DELTA ? 0 : 16 + (words + traits.size()) * 8, 4);
+	put_le(header, 0, 4);
+
+	for (size_t f(0); f < traits.size(); f++) {
+		const TraitValue v = probe_type(traits[f]);
+		const char *name = SystemInfo::getName(traits[f]);
+		const size_t len = strlen(name);
+
+		if (v.type == TypeString || v.type == TypeNone || len > UINT8_MAX)
+			return -1;
+		types.push_back(v.type);
+		put_le(header, traits[f], 2);
+		header.push_back((uint8_t)v.type);
+		header.push_back((uint8_t)v.unit);
+		header.push_back((uint8_t)len);
+		header.insert(header.end(), name, name + len);
+	}
+	while (header.size() % 8)
+		header.push_back(0);
+	for (int b(0); b < 4; b++)
+		header[12 + b] = (uint8_t)(header.size() >> (b * 8));
+
+	if (fwrite(header.data(), header.size(), 1, out) != 1)
+		return -1;
+	this->out = out;
+	return 0;
+}
+
+int
+RecordWriter::write (const struct SystemSnapshot *snap)
+{
+	if (!out || !snap)
+		return -1;
+
+	bitmap.assign(bitmap_words(traits.size()), 0);
+	payload.clear();
+	record.clear();
+	if (!(flags & RECORD_DELTA)) {
+		put_le(record, snap->timestamp, 8);
+		put_le(record, (uint32_t)snap->pid, 4);
+		put_le(record, 0, 4);
+		record.resize(record.size() + bitmap.size() * 8);
+	}
+	else {
+		put_varint(payload, snap->timestamp - prev_timestamp);
+		put_varint(payload, zigzag((int64_t)snap->pid - prev_pid));
+		payload.resize(payload.size() + bitmap.size() * 8);
+		prev_timestamp = snap->timestamp;
+		prev_pid = snap->pid;
+	}
+
+	/** bitmap words are filled in after the values are known **/
+	const size_t bitmap_at = flags & RECORD_DELTA ? payload.size() - bitmap.size() * 8 
+	                                              : 16;
+
+	for (size_t f(0); f < traits.size(); f++) {
+		const TraitValue v = SystemInfo::getSnapshotValue(traits[f], snap);
+		const uint64_t bits = v.type == TypeNone ? 0 : value_bits(v);
+
+		if (v.type != TypeNone)
+			bitmap[f / 64] |= 1ULL << (f % 64);
+
+		if (!(flags & RECORD_DELTA))
+			put_le(record, bits, 8);
+		else if (types[f] == TypeDouble)
+			put_le(payload, bits, 8);
+		else
+			put_varint(payload, zigzag((int64_t)(bits - prev[f])));
+		prev[f] = bits;
+	}
+
+	std::vector< uint8_t > &target = flags & RECORD_DELTA ? payload : record;
+	for (size_t w(0); w < bitmap.size(); w++) {
+		for (int b(0); b < 8; b++)
+			target[bitmap_at + w * 8 + b] = (uint8_t)(bitmap[w] >> (b * 8));
+	}
+
+	if (flags & RECORD_DELTA) {
+		put_varint(record, payload.size());
+		record.insert(record.end(), payload.begin(), payload.end());
+	}
+	return fwrite(record.data(), record.size(), 1, out) == 1 ? 0 : -1;
+}
+
+RecordReader::RecordReader() : map( NULL ),
+                               map_size( 0 ),
+                               header_size( 0 ),
+                               record_size( 0 ),
+                               offset( 0 ),
+                               file_version( 0 ),
+                               file_flags( 0 )
+{
+}
+
+RecordReader::~RecordReader()
+{
+	close();
+}
+
+void
+RecordReader::close ()
+{
+	if (map)
+		munmap((void *)map, map_size);
+	map = NULL;
+	map_size = header_size = record_size = offset = 0;
+	field_list.clear();
+}
+
+int
+RecordReader::open (const char *path)
+{
+	struct stat st;
+	const uint8_t *p, *end;
+	size_t fields;
+	void *ptr;
+	int fd;
+
+	close();
+	if ((fd = ::open(path, O_RDONLY | O_CLOEXEC)) < 0)
+		return -1;
+	if (fstat(fd, &st) < 0 || st.st_size < HEADER_FIXED_SIZE) {
+		::close(fd);
+		return -1;
+	}
+	ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (ptr == MAP_FAILED)
+		return -1;
+	map = (const uint8_t *)ptr;
+	map_size = st.st_size;
+
+	if (memcmp(map, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0)
+		goto bad;
+	file_version = get_le(map + 6, 2);
+	file_flags = get_le(map + 8, 2);
+	fields = get_le(map + 10, 2);
+	header_size = get_le(map + 12, 4);
+	record_size = get_le(map + 16, 4);
+	if (file_version != RECORD_VERSION || header_size > map_size || 
+	    header_size < HEADER_FIXED_SIZE)
+		goto bad;
+	/** get() and next() index fixed width records by this size **/
+	if (!isDelta() && record_size != 16 + (bitmap_words(fields) + fields) * 8)
+		goto bad;
+
+	p = map + HEADER_FIXED_SIZE;
+	end = map + header_size;
+	for (size_t f(0); f < fields; f++) {
+		RecordField field;
+
+		if (end - p < 5 || end - p < 5 + p[4])
+			goto bad;
+		field.trait = get_le(p, 2);
+		field.type = (ValueType)p[2];
+		field.unit = (Unit)p[3];
+		field.name.assign((const char *)p + 5, p[4]);
+		p += 5 + p[4];
+		field_list.push_back(field);
+	}
+
+	rewind();
+	return 0;
+
+bad:
+	close();
+	return -1;
+}
+
+int
+RecordReader::fieldIndex (const char *name) const
+{
+	for (size_t f(0); f < field_list.size(); f++) {
+		if (field_list[f].name == name)
+			return (int)f;
+	}
+	return -1;
+}
+
+size_t
+RecordReader::size () const
+{
+	if (!map || isDelta())
+		return 0;
+	return (map_size - header_size) / record_size;
+}
+
+uint64_t
+RecordReader::get (const size_t i, const size_t f) const
+{
+	const uint8_t *rec = map + header_size + i * record_size;
+
+	return get_le(rec + 16 + (bitmap_words(field_list.size()) + f) * 8, 8);
+}
+
+void
+RecordReader::rewind ()
+{
+	offset = header_size;
+	prev.timestamp = 0;
+	prev.pid = 0;
+	prev.values.assign(field_list.size(), 0);
+	prev.present.assign(field_list.size(), false);
+}
+
+bool
+RecordReader::next (struct RecordSample *sample)
+{
+	const size_t fields = field_list.size(), words = bitmap_words(fields);
+	const uint8_t *p = map + offset, *end = map + map_size, *bitmap;
+	uint64_t v;
+
+	if (!map)
+		return false;
+
+	if (!isDelta()) {
+		if ((size_t)(end - p) < record_size)
+			return false;
+		sample->timestamp = get_le(p, 8);
+		sample->pid = (int)(int32_t)get_le(p + 8, 4);
+		bitmap = p + 16;
+		p = bitmap + words * 8;
+		sample->values.resize(fields);
+		sample->present.resize(fields);
+		for (size_t f(0); f < fields; f++) {
+			sample->values[f] = get_le(p + f * 8, 8);
+			sample->present[f] = (get_le(bitmap + (f / 64) * 8, 8) >> (f % 64)) & 1;
+		}
+		offset += record_size;
+		return true;
+	}
+
+	if (!get_varint(&p, end, &v) || (size_t)(end - p) < v)
+		return false;
+	end = p + v;
+	offset = end - map;
+
+	if (!get_varint(&p, end, &v))
+		return false;
+	prev.timestamp += v;
+	if (!get_varint(&p, end, &v))
+		return false;
+	prev.pid += (int)unzigzag(v);
+	if ((size_t)(end - p) < words * 8)
+		return false;
+	bitmap = p;
+	p += words * 8;
+
+	for (size_t f(0); f < fields; f++) {
+		if (field_list[f].type == TypeDouble) {
+			if (end - p < 8)
+				return false;
+			prev.values[f] = get_le(p, 8);
+			p += 8;
+		}
+		else {
+			if (!get_varint(&p, end, &v))
+				return false;
+			prev.values[f] += (uint64_t)unzigzag(v);
+		}
+		prev.present[f] = (get_le(bitmap + (f / 64) * 8, 8) >> (f % 64)) & 1;
+	}
+
+	*sample = prev;
+	return true;
+}
+
+TraitValue
+RecordReader::value (const struct RecordSample *sample, const size_t f) const
+{
+	TraitValue v;
+
+	if (f >= field_list.size() || !sample->present[f])
+		return v;
+	v.type = field_list[f].type;
+	v.unit = field_list[f].unit;
+	if (v.type == TypeDouble)
+		memcpy(&v.d, &sample->values[f], sizeof(v.d));
+	else
+		v.u = sample->values[f];
+	return v;
+}
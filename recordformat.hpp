@@ -0,0 +1,177 @@
+/**
+ * recordformat.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _RECORDFORMAT_HPP_
+#define _RECORDFORMAT_HPP_  1
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "systeminfo.hpp"
+
+/**
+ * Binary sample stream, all integers little-endian:
+ *
+ *   header   "SIREC\0" magic, u16 version, u16 flags, u16 fields,
+ *            u32 header_size, u32 record_size, u32 reserved
+ *   fields   per field u16 trait, u8 ValueType, u8 Unit, u8 name
+ *            length, name; padded with zeros to header_size, a
+ *            multiple of 8.  Names, not ids, identify a trait across
+ *            versions of the Trait enum.
+ *   records  fixed: u64 timestamp, i32 pid, u32 reserved, a present
+ *            bitmap of one bit per field in u64 words, then one u64
+ *            per field (unsigned, signed two's complement or IEEE
+ *            double bits).  record_size bytes each, so record i is at
+ *            header_size + i * record_size.
+ *            RECORD_DELTA: varint payload length, varint timestamp
+ *            delta, zigzag varint pid delta, the bitmap words, then
+ *            per field a zigzag varint of the difference from the
+ *            previous record (doubles as raw u64).  record_size is 0
+ *            and records can only be read in order.
+ *
+ * String traits have no fixed width encoding and are not
+ * recordable.
+ */
+#define RECORD_MAGIC    "SIREC"
+#define RECORD_VERSION  1
+#define RECORD_DELTA    0x1
+
+struct RecordField{
+   int         trait;   /* Trait id of the writer, may differ from ours */
+   ValueType   type;
+   Unit        unit;
+   std::string name;
+};
+
+/**
+ * RecordSample - one decoded record; values[f] holds the raw
+ * 64 bits of field f, present[f] whether the trait was available.
+ */
+struct RecordSample{
+   uint64_t                timestamp;
+   int                     pid;
+   std::vector< uint64_t > values;
+   std::vector< bool >     present;
+};
+
+/**
+ * RecordWriter - appends samples of a fixed trait list to a stream.
+ */
+class RecordWriter
+{
+public:
+   RecordWriter();
+
+   /**
+    * open - write the schema header for traits to out, which the
+    * caller keeps owning.
+    * @param flags - 0 or RECORD_DELTA
+    * @return  int - 0 on success, -1 on a string trait or write error
+    */
+   int open (FILE *out, const std::vector< Trait > &traits, const unsigned flags);
+
+   /**
+    * write - append one record with the traits of snap.
+    * @return  int - 0 on success, -1 on write error
+    */
+   int write (const struct SystemSnapshot *snap);
+
+   /**
+    * recordable - the traits with a fixed width encoding, all but
+    * the string traits.
+    */
+   static std::vector< Trait > recordable ();
+
+private:
+   FILE                   *out;
+   unsigned                flags;
+   std::vector< Trait >    traits;
+   std::vector< ValueType > types;
+   std::vector< uint64_t > prev;
+   uint64_t                prev_timestamp;
+   int                     prev_pid;
+   std::vector< uint8_t >  record;  /* reused by every write */
+   std::vector< uint8_t >  payload;
+   std::vector< uint64_t > bitmap;
+};
+
+/**
+ * RecordReader - maps a record file read-only.  Fixed width files
+ * can be read at random with get() straight from the mapping; both
+ * kinds can be walked in order with next().
+ */
+class RecordReader
+{
+public:
+   RecordReader();
+   ~RecordReader();
+
+   RecordReader( const RecordReader &other )              = delete;
+   RecordReader &operator = ( const RecordReader &other ) = delete;
+
+   /**
+    * open - map path and parse its header.
+    * @return  int - 0 on success, -1 if unreadable or not a record file
+    */
+   int open (const char *path);
+   void close ();
+
+   unsigned version () const { return file_version; }
+   bool isDelta () const { return (file_flags & RECORD_DELTA) != 0; }
+   const std::vector< RecordField > &fields () const { return field_list; }
+
+   /** fieldIndex - position of the named trait, -1 if not recorded **/
+   int fieldIndex (const char *name) const;
+
+   /** size - number of fixed width records, 0 for delta files **/
+   size_t size () const;
+
+   /**
+    * get - raw bits of field f in record i of a fixed width file,
+    * no bounds checks.
+    */
+   uint64_t get (const size_t i, const size_t f) const;
+
+   /**
+    * next - decode the next record in order.
+    * @return  bool - false at the end or on a truncated record
+    */
+   bool next (struct RecordSample *sample);
+
+   /** rewind - make next() start over at the first record **/
+   void rewind ();
+
+   /** value - field f of sample as a TraitValue **/
+   TraitValue value (const struct RecordSample *sample, const size_t f) const;
+
+private:
+   const uint8_t             *map;
+   size_t                     map_size;
+   size_t                     header_size;
+   size_t                     record_size;
+   size_t                     offset;
+   unsigned                   file_version;
+   unsigned                   file_flags;
+   std::vector< RecordField > field_list;
+   struct RecordSample        prev;
+};
+
+#endif /* END _RECORDFORMAT_HPP_ */
@@ -0,0 +1,245 @@
+/**
+ * shmring.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "shmring.hpp"
+
+#define SHM_DIR "/dev/shm/"
+
+/**
+ * Header - first cache line of the mapping; head sits on its own
+ * line so consumers polling it don't share a line with the slots.
+ */
+struct ShmRingHeader{
+   char     magic[8];
+   uint32_t version;
+   uint32_t slots;
+   uint32_t slot_size;
+   uint32_t reserved;
+   char     pad0[64 - 24];
+   uint64_t head;
+   char     pad1[64 - 8];
+};
+
+struct ShmRingSlot{
+   uint32_t         seq;
+   uint32_t         reserved;
+   struct ShmSample sample;
+};
+
+static inline size_t slot_stride ()
+{
+	return (sizeof(ShmRingSlot) + 63) & ~(size_t)63;
+}
+
+ShmRing::ShmRing() : fd( -1 ),
+                     map( MAP_FAILED ),
+                     map_size( 0 ),
+                     header( NULL ),
+                     producer( false )
+{
+}
+
+ShmRing::~ShmRing()
+{
+	close();
+}
+
+void
+ShmRing::close ()
+{
+	if (map != MAP_FAILED)
+		munmap(map, map_size);
+	if (fd >= 0)
+		::close(fd);
+	map = MAP_FAILED;
+	map_size = 0;
+	header = NULL;
+	producer = false;
+	fd = -1;
+}
+
+int
+ShmRing::create (const char *name, const unsigned slots)
+{
+	close();
+	if (slots == 0)
+		return -1;
+
+	if (name) {
+		const std::string path = std::string(SHM_DIR) + name;
+
+		/** a stale ring of a crashed collector is simply replaced **/
+		unlink(path.c_str());
+		fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	}
+	else {
+		fd = (int)syscall(SYS_memfd_create, "sysinfo-ring", 0);
+	}
+	if (fd < 0) {
+		perror("Failed to create shared ring");
+		return -1;
+	}
+
+	map_size = sizeof(ShmRingHeader) + slots * slot_stride();
+	if (ftruncate(fd, map_size) < 0 ||
+	    (map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		perror("Failed to map shared ring");
+		close();
+		return -1;
+	}
+
+	/** the file is zero filled: head 0 and every slot sequence even **/
+	header = (ShmRingHeader *)map;
+	header->version = SHM_RING_VERSION;
+	header->slots = slots;
+	header->slot_size = (uint32_t)slot_stride();
+	/** magic last, a consumer attaching now sees a complete header or none **/
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(header->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC));
+	producer = true;
+	return 0;
+}
+
+int
+ShmRing::attach (const char *name)
+{
+	std::string path(name);
+	struct stat st;
+
+	close();
+	if (path.find('/') == std::string::npos)
+		path = SHM_DIR + path;
+
+	if ((fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC)) < 0)
+		return -1;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ShmRingHeader)) {
+		close();
+		return -1;
+	}
+	map_size = st.st_size;
+	if ((map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		close();
+		return -1;
+	}
+	header = (ShmRingHeader *)map;
+
+	if (memcmp(header->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC)) != 0 ||
+	    header->version != SHM_RING_VERSION || header->slot_size != slot_stride() ||
+	    header->slots == 0 ||
+	    sizeof(ShmRingHeader) + (size_t)header->slots * slot_stride() > map_size) {
+		close();
+		return -1;
+	}
+	return 0;
+}
+
+ShmRingSlot *
+ShmRing::slot (const uint64_t index) const
+{
+	return (ShmRingSlot *)((char *)map + sizeof(ShmRingHeader) + (index % header->slots) * slot_stride());
+}
+
+int
+ShmRing::publish (struct ShmSample *sample)
+{
+	/** attached rings are mapped read-only **/
+	if (!header || !producer)
+		return -1;
+
+	const uint64_t index = header->head;
+	ShmRingSlot *s = slot(index);
+	const uint32_t seq = s->seq;
+
+	sample->index = index;
+
+	/** odd while the slot is being written **/
+	__atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(&s->sample, sample, sizeof(struct ShmSample));
+	__atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+
+	__atomic_store_n(&header->head, index + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+uint64_t
+ShmRing::published () const
+{
+	return header ? __atomic_load_n(&header->head, __ATOMIC_ACQUIRE) : 0;
+}
+
+int
+ShmRing::read (const uint64_t index, struct ShmSample *sample) const
+{
+	const ShmRingSlot *s;
+	uint32_t before, after;
+	int tries = 0;
+
+	if (!header || index >= published())
+		return -1;
+
+	s = slot(index);
+	do {
+		while ((before = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)) & 1) {
+			if (++tries >= SHM_READ_RETRIES) {
+				errno = EAGAIN;
+				return -1;
+			}
+		}
+		memcpy(sample, &s->sample, sizeof(struct ShmSample));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		after = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+		if (before != after && ++tries >= SHM_READ_RETRIES) {
+			errno = EAGAIN;
+			return -1;
+		}
+	} while (before != after);
+
+	/** the producer has lapped us and reused the slot **/
+	return sample->index == index ? 0 : -1;
+}
+
+int
+ShmRing::latest (struct ShmSample *sample) const
+{
+	const uint64_t head = published();
+
+	if (head == 0)
+		return -1;
+	if (read(head - 1, sample) == 0)
+		return 0;
+	/** the producer lapped the whole ring meanwhile, or is stuck **/
+	for (int tries(0); tries < SHM_READ_RETRIES; tries++) {
+		if (read(published() - 1, sample) == 0)
+			return 0;
+	}
+	errno = EAGAIN;
+	return -1;
+}
@@ -0,0 +1,125 @@
+/**
+ * shmring.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _SHMRING_HPP_
+#define _SHMRING_HPP_  1
+#include <cstddef>
+#include <cstdint>
+
+#include "systeminfo.hpp"
+
+#define SHM_RING_MAGIC   "SISHM"
+#define SHM_RING_VERSION 1
+#define SHM_RING_SLOTS   64
+/** attempts before read() gives up on a slot being written **/
+#define SHM_READ_RETRIES 4096
+
+struct ShmRingHeader;
+struct ShmRingSlot;
+
+/**
+ * ShmSample - what a collector publishes per sample.
+ */
+struct ShmSample{
+   uint64_t              index;     /* 0 based sample number */
+   uint64_t              timestamp; /* CLOCK_MONOTONIC ns */
+   int                   pid;
+   struct ProcStatData   stat;
+   struct ProcStatusData status;
+   uint64_t              meminfo[Hugepagesize - MemTotal + 1];
+};
+
+/**
+ * ShmRing - single producer, many consumer ring of ShmSamples in
+ * shared memory (a /dev/shm file or a memfd).  Every slot carries
+ * a sequence counter that is odd while the producer writes it;
+ * consumers copy the slot and retry if the counter was odd or
+ * changed meanwhile (a seqlock), so the producer never waits for
+ * anyone and reading costs no syscall once mapped.  head counts
+ * the samples published, sample i lives in slot i % slots.  A
+ * consumer that falls more than slots behind finds its sample
+ * overwritten and read() says so.
+ */
+class ShmRing
+{
+public:
+   ShmRing();
+   ~ShmRing();
+
+   ShmRing( const ShmRing &other )              = delete;
+   ShmRing &operator = ( const ShmRing &other ) = delete;
+
+   /**
+    * create - producer side.  name is a file under /dev/shm,
+    * replaced if it exists; NULL makes an anonymous memfd whose
+    * fd (getFd) can be passed to consumers.
+    * @return  int - 0 on success, -1 on failure
+    */
+   int create (const char *name, const unsigned slots = SHM_RING_SLOTS);
+
+   /**
+    * attach - consumer side, map name (as given to create) or a
+    * path such as /proc/<pid>/fd/<n> read-only.
+    * @return  int - 0 on success, -1 if missing or not a ring
+    *          (including one with no slots)
+    */
+   int attach (const char *name);
+
+   void close ();
+
+   int getFd () const { return fd; }
+
+   /**
+    * publish - producer only, copy sample into the next slot.
+    * sample->index is set to its position in the stream.
+    * @return  int - 0 on success, -1 if the ring wasn't created here
+    */
+   int publish (struct ShmSample *sample);
+
+   /** published - number of samples published so far **/
+   uint64_t published () const;
+
+   /**
+    * read - copy sample index out of the ring.
+    * @return  int - 0 on success, -1 if not published yet or
+    *          already overwritten, -1 with errno EAGAIN if the
+    *          slot stayed mid-write for SHM_READ_RETRIES attempts
+    *          (a producer that died while publishing)
+    */
+   int read (const uint64_t index, struct ShmSample *sample) const;
+
+   /**
+    * latest - copy the newest sample.
+    * @return  int - 0 on success, -1 if nothing was published,
+    *          -1 with errno EAGAIN if no read succeeded within
+    *          SHM_READ_RETRIES attempts
+    */
+   int latest (struct ShmSample *sample) const;
+
+private:
+   ShmRingSlot *slot (const uint64_t index) const;
+
+   int     fd;
+   void   *map;
+   size_t  map_size;
+   ShmRingHeader *header;
+   bool    producer; /* created here, mapped writable */
+};
+
+#endif /* END _SHMRING_HPP_ */
@@ -0,0 +1,70 @@
+/**
+ * systemcontext.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+
+#include "systemcontext.hpp"
+
+SystemContext::SystemContext() : have_sample( false )
+{
+	memset(&snap, 0, sizeof(struct SystemSnapshot));
+	memset(&rates, 0, sizeof(struct ProcRates));
+}
+
+int
+SystemContext::open (const int pid, const TraitSet &traits)
+{
+	have_sample = false;
+	this->traits = traits;
+	sampler.reset();
+	memset(&rates, 0, sizeof(struct ProcRates));
+	return reader.open(pid, traits.sources());
+}
+
+void
+SystemContext::close ()
+{
+	have_sample = false;
+	reader.close();
+}
+
+int
+SystemContext::sample ()
+{
+	if (reader.getPid() < 0)
+		return -1;
+	have_sample = (SystemInfo::snapshot(&snap, &reader, traits) == 0);
+	if (have_sample)
+		sampler.sample(&snap, &rates);
+	return have_sample ? 0 : -1;
+}
+
+TraitValue
+SystemContext::getValue (const Trait trait) const
+{
+	if (!have_sample || !traits.test(trait))
+		return TraitValue();
+	return SystemInfo::getSnapshotValue(trait, &snap);
+}
+
+std::string
+SystemContext::getProperty (const Trait trait) const
+{
+	return SystemInfo::valueToString(getValue(trait));
+}
@@ -0,0 +1,104 @@
+/**
+ * systemcontext.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _SYSTEMCONTEXT_HPP_
+#define _SYSTEMCONTEXT_HPP_  1
+#include <string>
+#include <vector>
+
+#include "systeminfo.hpp"
+#include "procreader.hpp"
+#include "ratesampler.hpp"
+
+/**
+ * SystemContext - everything needed to sample one pid, owned by
+ * the caller: the ProcReader with its open fds and buffer and the
+ * last snapshot taken.  Trait queries are answered from that
+ * snapshot, so results never depend on which trait was asked for
+ * first.  Each sample also updates the per second rates of the
+ * process' counters since the previous one.  A context is not
+ * shared between threads; a collector keeps one per pid it
+ * samples and needs no lock.
+ */
+class SystemContext
+{
+public:
+   SystemContext();
+
+   SystemContext( const SystemContext &other )              = delete;
+   SystemContext &operator = ( const SystemContext &other ) = delete;
+
+   /**
+    * open - start sampling pid, dropping any previous pid.  Only
+    * the sources backing traits are opened and read by sample();
+    * any other trait reads as TypeNone.  The Perf* traits are only
+    * sampled when traits asks for them.
+    * @return  int - 0 on success, -1 if pid can't be opened
+    */
+   int open (const int pid, const TraitSet &traits = TraitSet::defaults());
+
+   void close ();
+
+   /**
+    * sample - take a fresh snapshot of the pid.
+    * @return  int - 0 on success, -1 if the pid is gone
+    */
+   int sample ();
+
+   /** valid - true once sample() has succeeded for the open pid **/
+   bool valid () const { return have_sample; }
+
+   int getPid () const { return reader.getPid(); }
+
+   /**
+    * getValue - trait from the last snapshot, TypeNone before the
+    * first successful sample() or for a trait not asked for.
+    */
+   TraitValue getValue (const Trait trait) const;
+
+   std::string getProperty (const Trait trait) const;
+
+   const struct SystemSnapshot &getSnapshot () const { return snap; }
+
+   /**
+    * getRates - rates between the last two samples, rates.valid is
+    * false until there have been two.
+    */
+   const struct ProcRates &getRates () const { return rates; }
+
+   /**
+    * getCpuUsage - usage of every online cpu between the last two
+    * samples, when a Cpu* trait is sampled.
+    * @return  int - 0 on success, -1 before the second sample
+    */
+   int getCpuUsage (std::vector< CpuUsage > &out) const
+   {
+      return reader.cpus().usage(out);
+   }
+
+private:
+   ProcReader            reader;
+   TraitSet              traits;
+   struct SystemSnapshot snap;
+   RateSampler           sampler;
+   struct ProcRates      rates;
+   bool                  have_sample;
+};
+
+#endif /* END _SYSTEMCONTEXT_HPP_ */
@@ -21,7 +21,9 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
+#include <climits>
 #include <cinttypes>
+#include <mutex>
 #include <sys/utsname.h>
 
 #if __linux
@@ -34,6 +36,7 @@
 #endif
 #include <sched.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/resource.h>
 
 /** just in case thee aren't defined, go ahead and define them **/
@@ -53,66 +56,65 @@
 #endif
 
 #include "systeminfo.hpp"
+#include "procparse.hpp"
+#include "procreader.hpp"
+#include "topology.hpp"
+#include "cgroup.hpp"
+#include "pressure.hpp"
+#include "cpustat.hpp"
 
-int getrlimit_trait (const Trait trait)
+int rlimit_resource (const Trait trait)
 {
-   	struct rlimit rlim;
-   	int val = 0;
-   	
-   	switch (trait) {
-   		case (VirtualMemory): 
-   			val = getrlimit(RLIMIT_AS, &rlim);
-   			break;
-   		case (CoreFile): 
-   		   	val = getrlimit(RLIMIT_CORE, &rlim);
-   			break;
-   		case (CPUTime):
-   			val = getrlimit(RLIMIT_CPU, &rlim);
-   			break;
+	switch (trait) {
+		case (VirtualMemory): 
+			return RLIMIT_AS;
+		case (CoreFile): 
+			return RLIMIT_CORE;
+		case (CPUTime):
+			return RLIMIT_CPU;
 		case (DataSegment):
-   			val = getrlimit(RLIMIT_DATA, &rlim);
-   			break;		 
+			return RLIMIT_DATA;
 		case (MaxFileSize): 
-   			val = getrlimit(RLIMIT_FSIZE, &rlim);
-   			break;		
+			return RLIMIT_FSIZE;
 		case (LockLimit): 
-   			val = getrlimit(RLIMIT_LOCKS, &rlim);
-   			break;		
+			return RLIMIT_LOCKS;
 		case (MaxMemLock): 
-   			val = getrlimit(RLIMIT_MEMLOCK, &rlim);
-   			break;		
+			return RLIMIT_MEMLOCK;
 		case (MsgQueueLimit):
-   			val = getrlimit(RLIMIT_MSGQUEUE, &rlim);
-   			break;		
+			return RLIMIT_MSGQUEUE;
 		case (MaxNice):
-   			val = getrlimit(RLIMIT_NICE, &rlim);
-   			break;		
+			return RLIMIT_NICE;
 		case (MaxFD):
-   			val = getrlimit(RLIMIT_NOFILE, &rlim);
-   			break;		
+			return RLIMIT_NOFILE;
 		case (MaxNumProcesses):
-   			val = getrlimit(RLIMIT_NPROC, &rlim);
-   			break;		
+			return RLIMIT_NPROC;
 		case (MaxRAMPages):
-   			val = getrlimit(RLIMIT_RSS, &rlim);
-   			break;		
+			return RLIMIT_RSS;
 		case (MaxPriority):
-   			val = getrlimit(RLIMIT_RTPRIO, &rlim);
-   			break;		
+			return RLIMIT_RTPRIO;
 		case (MaxRTime):
 #ifdef RLIMIT_RTTIME
-   			val = getrlimit(RLIMIT_RTTIME, &rlim);
-#endif   			
-   			break;		
+			return RLIMIT_RTTIME;
+#else
+			return -1;
+#endif
 		case (MaxSignalQueue):
-   			val = getrlimit(RLIMIT_SIGPENDING, &rlim);
-   			break;		
+			return RLIMIT_SIGPENDING;
 		case (MaxStackSize):
-   			val = getrlimit(RLIMIT_STACK, &rlim);
-   			break;		
-   	}
+			return RLIMIT_STACK;
+	}
 
-   	if (val < 0)
+	return -1;
+}
+
+int getrlimit_trait (const Trait trait)
+{
+   	struct rlimit rlim;
+   	int resource = rlimit_resource(trait);
+   	
+   	memset(&rlim, 0, sizeof(rlim));
+   	
+   	if (resource >= 0 && getrlimit(resource, &rlim) < 0)
    		perror("getrlimit");
    	
    	return rlim.rlim_max;
@@ -132,6 +134,8 @@ std::string schedule_str (const int schedule)
 		case SCHED_RR:
 			return "SCHED_RR";
 	}
+
+	return std::to_string(schedule);
 }
 
 int cache_handle (const Trait trait)
@@ -172,38 +176,86 @@ int cache_handle (const Trait trait)
 	return 0;
 }
 
-std::string SystemInfo::sysinfo_to_string (const Trait trait, struct sysinfo info)
+static TraitValue uint_value (const uint64_t val, const Unit unit)
+{
+	TraitValue v;
+
+	v.type = TypeUnsigned;
+	v.unit = unit;
+	v.u = val;
+	return v;
+}
+
+static TraitValue int_value (const int64_t val, const Unit unit)
+{
+	TraitValue v;
+
+	v.type = TypeSigned;
+	v.unit = unit;
+	v.i = val;
+	return v;
+}
+
+static TraitValue double_value (const double val, const Unit unit)
+{
+	TraitValue v;
+
+	v.type = TypeDouble;
+	v.unit = unit;
+	v.d = val;
+	return v;
+}
+
+static TraitValue string_value (const char *val)
+{
+	TraitValue v;
+
+	v.type = TypeString;
+	v.s = val;
+	return v;
+}
+
+TraitValue SystemInfo::sysinfo_value (const Trait trait, const struct sysinfo *info)
 {
 	switch (trait) {
 		case UpTime:
-			return std::to_string(info.uptime);   
+			return int_value(info->uptime, UnitSeconds);
 		case OneMinLoad:
-			return std::to_string(info.loads[0]);
+			return uint_value(info->loads[0], UnitLoadFixed);
 		case FiveMinLoad:
-			return std::to_string(info.loads[1]);
+			return uint_value(info->loads[1], UnitLoadFixed);
 		case FifteenMinLoad:
-			return std::to_string(info.loads[2]);
+			return uint_value(info->loads[2], UnitLoadFixed);
 		case TotalMainMemory:
-			return std::to_string(info.totalram);
+			return uint_value(info->totalram, UnitMemoryUnits);
 		case FreeRam:
-			return std::to_string(info.freeram);
+			return uint_value(info->freeram, UnitMemoryUnits);
 		case SharedRam:
-			return std::to_string(info.sharedram);
+			return uint_value(info->sharedram, UnitMemoryUnits);
 		case BufferRam:
-			return std::to_string(info.bufferram);
+			return uint_value(info->bufferram, UnitMemoryUnits);
 		case TotalSwap:
-			return std::to_string(info.totalswap);
+			return uint_value(info->totalswap, UnitMemoryUnits);
 		case FreeSwap:
-			return std::to_string(info.freeswap);
+			return uint_value(info->freeswap, UnitMemoryUnits);
 		case NumberOfProcessesRunning:
-			return std::to_string(info.procs);
+			return uint_value(info->procs, UnitCount);
 		case TotalHighMemory:
-			return std::to_string(info.totalhigh);
+			return uint_value(info->totalhigh, UnitMemoryUnits);
 		case FreeHighMemory:
-			return std::to_string(info.freehigh);
+			return uint_value(info->freehigh, UnitMemoryUnits);
 		case MemoryUnit:
-			return std::to_string(info.mem_unit);
+			return uint_value(info->mem_unit, UnitBytes);
+		default:
+			break;
 	}
+
+	return TraitValue();
+}
+
+std::string SystemInfo::sysinfo_to_string (const Trait trait, struct sysinfo info)
+{
+	return valueToString(sysinfo_value(trait, &info));
 }
 
 std::string cstr_to_string (const char *cstr)
@@ -213,291 +265,185 @@ std::string cstr_to_string (const char *cstr)
 }
 
 
-std::string proc_stat_val (struct ProcStatData data, const Trait trait)
+TraitValue proc_stat_value (const struct ProcStatData *data, const Trait trait)
 {
 	switch (trait) {
    		case pid1:
-   			return std::to_string(data.pid);
+   			return int_value(data->pid, UnitNone);
 		case executable:
-			return cstr_to_string(data.executable);
-		case state:
-			return std::to_string(data.state);
+			return string_value(data->executable);
+		case state: {
+			const char str[2] = { data->state, '\0' };
+			return string_value(str);
+		}
 		case parent_pid: 
-			return std::to_string(data.parent_pid);
+			return int_value(data->parent_pid, UnitNone);
 		case group_id:
-			return std::to_string(data.group_id);
+			return int_value(data->group_id, UnitNone);
 		case session_id:
-			return std::to_string(data.session_id);
+			return int_value(data->session_id, UnitNone);
 		case tty_nr:
-			return std::to_string(data.tty_nr);
+			return int_value(data->tty_nr, UnitNone);
 		case foreground_id:
-			return std::to_string(data.foreground_id);
+			return int_value(data->foreground_id, UnitNone);
 		case flags:
-			return std::to_string(data.flags);
+			return uint_value(data->flags, UnitNone);
 		case minor_faults:
-			return std::to_string(data.minor_faults);
+			return uint_value(data->minor_faults, UnitCount);
 		case child_minor_faults:
-			return std::to_string(data.child_minor_faults);
+			return uint_value(data->child_minor_faults, UnitCount);
 		case major_faults:
-			return std::to_string(data.major_faults);
+			return uint_value(data->major_faults, UnitCount);
 		case child_major_faults:
-			return std::to_string(data.child_major_faults);
+			return uint_value(data->child_major_faults, UnitCount);
 		case uptime:
-			return std::to_string(data.uptime);
+			return uint_value(data->uptime, UnitTicks);
 		case scheduled_time:
-			return std::to_string(data.scheduled_time);
+			return uint_value(data->scheduled_time, UnitTicks);
 		case child_uptime:
-			return std::to_string(data.child_uptime);
+			return int_value(data->child_uptime, UnitTicks);
 		case child_scheduled_time:
-			return std::to_string(data.child_scheduled_time);
+			return int_value(data->child_scheduled_time, UnitTicks);
 		case priority1:
-			return std::to_string(data.priority);
+			return int_value(data->priority, UnitNone);
 		case nice1:
-			return std::to_string(data.nice);
+			return int_value(data->nice, UnitNone);
 		case number_threads:
-			return std::to_string(data.number_threads);
+			return int_value(data->number_threads, UnitCount);
 		case itrealvalue:
-			return std::to_string(data.itrealvalue);
+			return int_value(data->itrealvalue, UnitNone);
 		case start_time:
-			return std::to_string(data.start_time);
+			return uint_value(data->start_time, UnitTicks);
 		case virtual_mem_size_bytes:
-			return std::to_string(data.virtual_mem_size_bytes);
+			return uint_value(data->virtual_mem_size_bytes, UnitBytes);
 		case resident_mem_size:
-			return std::to_string(data.resident_mem_size);
+			return int_value(data->resident_mem_size, UnitPages);
 		case resident_mem_soft_limit:
-			return std::to_string(data.resident_mem_soft_limit);
+			return uint_value(data->resident_mem_soft_limit, UnitBytes);
 		case startcode:
-			return std::to_string(data.startcode);
+			return uint_value(data->startcode, UnitNone);
 		case endcode:
-			return std::to_string(data.endcode);
+			return uint_value(data->endcode, UnitNone);
 		case startstack:
-			return std::to_string(data.startstack);
+			return uint_value(data->startstack, UnitNone);
 		case curr_esp:
-			return std::to_string(data.curr_esp);
+			return uint_value(data->curr_esp, UnitNone);
 		case curr_eip:
-			return std::to_string(data.curr_eip);
+			return uint_value(data->curr_eip, UnitNone);
 		case signal_unused:
-			return std::to_string(data.signal_unused);
+			return uint_value(data->signal_unused, UnitNone);
 		case signal_ignore_unused:
-			return std::to_string(data.signal_ignore_unused);
+			return uint_value(data->signal_ignore_unused, UnitNone);
 		case signal_caught_unused:
-			return std::to_string(data.signal_caught_unused);
+			return uint_value(data->signal_caught_unused, UnitNone);
 		case channel:
-			return std::to_string(data.channel);
+			return uint_value(data->channel, UnitNone);
 		case pages_swapped:
-			return std::to_string(data.pages_swapped);
+			return uint_value(data->pages_swapped, UnitPages);
 		case cumulative_child_swapped_pages:
-			return std::to_string(data.cumulative_child_swapped_pages);
+			return uint_value(data->cumulative_child_swapped_pages, UnitPages);
 		case exit_signal:
-			return std::to_string(data.exit_signal);
+			return int_value(data->exit_signal, UnitNone);
 		case processor_last_executed_on:
-			return std::to_string(data.processor_last_executed_on);
+			return int_value(data->processor_last_executed_on, UnitNone);
 		case rt_schedule:
-			return std::to_string(data.rt_schedule);
+			return uint_value(data->rt_schedule, UnitNone);
 		case policy:
-			return std::to_string(data.policy);
+			return uint_value(data->policy, UnitNone);
 		case delayed_io_ticks:
-			return std::to_string(data.delayed_io_ticks);
+			return uint_value(data->delayed_io_ticks, UnitTicks);
 		case guest_time:
-			return std::to_string(data.guest_time);
+			return uint_value(data->guest_time, UnitTicks);
 		case child_guest_time:
-			return std::to_string(data.child_guest_time);
+			return int_value(data->child_guest_time, UnitTicks);
+		default:
+			break;
 	}
+
+	return TraitValue();
 }
 
 int proc_stat_init (struct ProcStatData *data, int pid)
 {
-	int fd;
-	char *path_buf, *stat_buf;
-	const size_t path_buf_size = 100, stat_buf_size = 1024;
+	char path[64], buf[PROC_BUFFER_SIZE];
+	ssize_t len;
 	
 	if (!data)
 		return -1;
 	
-	path_buf = (char *)calloc(sizeof(char), path_buf_size);
-	stat_buf = (char *)calloc(sizeof(char), stat_buf_size + 1);
-	
-	memset(data, 0, sizeof(struct ProcStatData));
-	
-	snprintf(path_buf, path_buf_size, "/proc/%d/stat", pid);
-	fd = open(path_buf, O_RDONLY);
-
-	if (!fd || read(fd, stat_buf, stat_buf_size) <= 0)
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+	if ((len = proc_read_file(path, buf, sizeof(buf))) < 0) {
+		memset(data, 0, sizeof(struct ProcStatData));
 		return -1;
+	}
 	
-	sscanf(stat_buf, "%d %s %c %d %d %d %d %d %d %lu %lu %lu %lu %lu %lu %lu "
-		   "%lu %lu %lu %lu %lu %llu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu "
-		   "%lu %lu %lu %lu %d %d %u %u %llu %lu %lu", 
-		&data->pid, data->executable, &data->state, &data->parent_pid, 
-		&data->group_id, &data->session_id, &data->tty_nr, &data->foreground_id,
-		&data->flags, &data->minor_faults, &data->child_minor_faults, 
-		&data->major_faults, &data->child_major_faults, &data->uptime, 
-		&data->scheduled_time, &data->child_uptime, &data->child_scheduled_time, 
-		&data->priority, &data->nice, &data->number_threads, &data->itrealvalue, 
-		&data->start_time, &data->virtual_mem_size_bytes, &data->resident_mem_size, 
-		&data->resident_mem_soft_limit, &data->startcode, &data->endcode, 
-		&data->startstack, &data->curr_esp, &data->curr_eip, &data->signal_unused, 
-		&data->signal_ignore_unused, &data->signal_caught_unused, 
-		&data->channel, &data->pages_swapped, &data->cumulative_child_swapped_pages,
-		&data->exit_signal, &data->processor_last_executed_on, &data->rt_schedule, 
-		&data->policy, &data->delayed_io_ticks, &data->guest_time, 
-		&data->child_guest_time);
-   
-	close(fd);
-	
-	free(path_buf);
-	free(stat_buf);
-	
-	return 0;
+	return proc_stat_parse(buf, len, data);
 }
 
-int parse_named_value (const char *path, const char *name, char *buf)
+/**
+ * for_each_named_value - walk a "key: value" file such as
+ * /proc/meminfo, /proc/cpuinfo or /proc/<pid>/status one line
+ * at a time, calling fn(key, val) with surrounding whitespace
+ * stripped from both.  Stops early when fn returns false.
+ */
+template <class Fn> static int
+for_each_named_value (const char *path, Fn fn)
 {
 	FILE *fp = NULL;
-      	char key[128], val[128];
-      	int count = EOF;
-      	
-	errno = 0;
-	
+	char line[4096];
+
 	if ((fp = fopen(path, "r")) == NULL)
 		return -1;
-		
-	memset(key, 0, sizeof(key));
-	memset(val, 0, sizeof(val));
-
-	while ((count = fscanf(fp, "%[^:]:%[^\n]\n", key, val)) != EOF) {
-		if (count == 2) {
-			if (!strncmp(key, name, strlen(name))) {
-				fclose(fp);
-				fp = NULL;
-				
-				strcpy(buf, val);
-				return 0;
-			}
-		}
-	}
 
-	if (fp) {
-		fclose(fp);
-		fp = NULL;
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		char *key = line, *val, *end;
+
+		if ((val = strchr(line, ':')) == NULL)
+			continue;
+
+		end = val;
+		*val++ = '\0';
+		while (end > key && isspace(end[-1]))
+			*--end = '\0';
+		while (isspace(*val))
+			val++;
+		end = val + strlen(val);
+		while (end > val && isspace(end[-1]))
+			*--end = '\0';
+
+		if (!fn(key, val))
+			break;
 	}
-	
-	return -1;
+
+	fclose(fp);
+	return 0;
 }
 
-std::string
-SystemInfo::getSystemProperty (const Trait trait, int pid)
+int parse_named_value (const char *path, const char *name, char *buf)
 {
-	static struct ProcStatData data;
-#if __linux
-	if (trait <= LevelFourCacheLineSize) {
-		int handle = cache_handle(trait);
-		long val(0);
-		
-		errno = 0;
-		
-		if ((val = sysconf(handle)) == -1)
-			perror("Failed to get config info");
+	int found = -1;
 
-		return std::to_string(val);
-	}
-	else if (trait == NumberOfProcessors) {
-		return std::to_string(get_nprocs()); 
-	}
-	else if (ProcessorName <= trait && trait <= ProcessorFrequency) {
-   		char buf[128];
-		const char *path = "/proc/cpuinfo";
-	
-		memset(buf, 0, sizeof(buf));
-		
-		switch (trait) {
-			case ProcessorName: 
-				parse_named_value("/proc/cpuinfo", "model name", buf);
-				
-				return cstr_to_string(buf);
-			case ProcessorFrequency:
-				parse_named_value(path, "cpu MHz", buf);
-				
-				errno = 0;
-				uint64_t frequency(strtof(buf, (char**)NULL) * 1e6f);
-				if (errno) {
-					perror("Failed to convert frequency from /proc/cpuinfo");
-					exit(EXIT_FAILURE);
-				}
-				return std::to_string(frequency);
-		}
-	}
-	else if (SystemName <= trait && trait <= MachineName) {
-		return SystemInfo::getUTSNameInfo(trait);
-	}
-	else if (UpTime <= trait && trait <= MemoryUnit) {
-		struct sysinfo info;
-		
-		std::memset(&info, 0, sizeof(struct sysinfo));
-		errno = 0;
-		if (sysinfo(&info) != 0)
-			perror( "Failed to get sysinfo!!" );
-			
-		return SystemInfo::sysinfo_to_string(trait, info);
-	}
-	else if (trait == Scheduler) {
-		return schedule_str(sched_getscheduler(0));
-	}
-	else if( trait == Priority ) {
-		errno = 0;
-		int priority(getpriority(PRIO_PROCESS, 0 /* self */ ) );
-		if (errno != 0)
-			perror("Failed to get process priority");
-		return std::to_string(priority);
-	}
-	else if (trait >= VirtualMemory && trait <= MaxStackSize) {
-		return std::to_string(getrlimit_trait(trait));
-	} 
-	else if (trait >= MemTotal && trait <= Hugepagesize) {
-		char buf[100];
-		int pos = 0;
-		const char *path = "/proc/meminfo";
-	
-		memset(buf, 0, sizeof(buf));
-	
-		parse_named_value(path, getName(trait), buf);
-	
-		while (isspace(buf[pos]))
-			pos++;
+	errno = 0;
 
-		std::string tmp(&buf[pos]);
-   		return tmp;
-	}
-	else if (trait >= voluntary_ctxt_switches && trait <= nonvoluntary_ctxt_switches) {
-		char *path = (char *)malloc(128);
-		char buf[100];
-		int pos = 0;
-		
-		sprintf(path, "/proc/%d/status", pid);
-	
-		memset(buf, 0, sizeof(buf));
-	
-		parse_named_value(path, getName(trait), buf);
-	
-		while (isspace(buf[pos]))
-			pos++;
+	for_each_named_value(path, [&](const char *key, const char *val) {
+		if (strncmp(key, name, strlen(name)))
+			return true;
 
-		std::string tmp(&buf[pos]);
-		free(path);
-		
-		if (trait == nonvoluntary_ctxt_switches) {
-			if (proc_stat_init(&data, pid) < 0) {
-				perror("/proc/stat init");
-				exit(-1);
-			}
-		}
-		
-   		return tmp;
-	}
-	else if (trait >= pid1 && trait <= child_guest_time) {
-		return proc_stat_val(data, trait);
-	}
-   
+		/** callers hand in fixed size buffers, keep the old 128 byte bound **/
+		strncpy(buf, val, 127);
+		buf[127] = '\0';
+		found = 0;
+		return false;
+	});
+
+	return found;
+}
+
+std::string
+SystemInfo::getSystemProperty (const Trait trait, int pid)
+{
+#if __linux
+	return valueToString(getSystemValue(trait, pid));
 #elif __APPLE__
    typedef int mib_t;
    mib_t mib[4];
@@ -924,6 +870,755 @@ SystemInfo::getSystemProperty (const Trait trait, int pid)
 }
 
 
+#if __linux
+Source trait_source (const Trait trait)
+{
+	if (trait <= NumberOfProcessors)
+		return SourceSysconf;
+	else if (trait <= ProcessorFrequency)
+		return SourceCpuinfo;
+	else if (trait <= MachineName)
+		return SourceUtsname;
+	else if (trait <= MemoryUnit)
+		return SourceSysinfo;
+	else if (trait <= Priority)
+		return SourceScheduler;
+	else if (trait <= MaxStackSize)
+		return SourceRlimit;
+	else if (trait <= Hugepagesize)
+		return SourceMeminfo;
+	else if (trait <= nonvoluntary_ctxt_switches)
+		return SourceStatus;
+	else if (trait <= child_guest_time)
+		return SourceStat;
+	else if (trait <= PerfCPUMigrations)
+		return SourcePerf;
+	else if (trait <= NumaRemoteMemory)
+		return SourceNuma;
+	else if (trait <= CpuFrequencyMax)
+		return SourceCpu;
+	else if (trait <= SmapsLocked)
+		return SourceSmaps;
+	else if (trait <= cancelled_write_bytes)
+		return SourceIO;
+	else if (trait <= PressureIOFullTotal)
+		return SourcePressure;
+	else if (trait <= CgroupPressureIOFullTotal)
+		return SourceCgroupPressure;
+
+	return SourceCgroup;
+}
+
+TraitSet
+TraitSet::defaults ()
+{
+	TraitSet s = all();
+
+	for (int t(PerfCycles); t <= PerfCPUMigrations; t++)
+		s.reset((Trait)t);
+	return s;
+}
+
+uint32_t
+TraitSet::sources () const
+{
+	uint32_t mask = 0;
+
+	for (int t(0); t < N; t++) {
+		if (bits.test(t))
+			mask |= 1u << trait_source((Trait)t);
+	}
+	return mask;
+}
+
+/**
+ * boot_cpu_caches - sysfs cache topology of cpu 0, read once; the
+ * hardware doesn't change under us.
+ */
+static const CacheTopology &boot_cpu_caches ()
+{
+	static const CacheTopology topology = []() {
+		CacheTopology t;
+
+		t.load(0);
+		return t;
+	}();
+
+	return topology;
+}
+
+/**
+ * host_numa - node layout of the host, read once; only the free
+ * memory changes and that is read fresh per sample.
+ */
+static const NumaTopology &host_numa ()
+{
+	static const NumaTopology topology = []() {
+		NumaTopology t;
+
+		t.load();
+		return t;
+	}();
+
+	return topology;
+}
+
+static int read_source (struct SystemSnapshot *snap, const Source source,
+                        ProcReader *reader = NULL)
+{
+	char path[64], buf[PROC_BUFFER_SIZE];
+	ssize_t len;
+
+	switch (source) {
+		case SourceSysconf:
+			for (int t(LevelOneICacheSize); t <= LevelFourCacheLineSize; t++) {
+				errno = 0;
+				if ((snap->cache[t] = sysconf(cache_handle((Trait)t))) == -1 && errno)
+					perror("Failed to get config info");
+
+				/** 
+				 * static glibc and many kernels report 0 or nothing here,
+				 * sysfs knows better
+				 */
+				if (snap->cache[t] <= 0)
+					snap->cache[t] = boot_cpu_caches().traitValue((Trait)t, 0);
+			}
+			snap->number_processors = get_nprocs();
+			return 0;
+		case SourceCpuinfo: {
+			struct CpuSample cpu;
+			int ret;
+
+			/** cpuinfo is large, stop once the first processor has been seen **/
+			ret = for_each_named_value("/proc/cpuinfo", 
+			                            [&](const char *key, const char *val) {
+				if (!strcmp(key, "model name") && !snap->processor_name[0])
+					strncpy(snap->processor_name, val, 
+					        sizeof(snap->processor_name) - 1);
+				else if (!strcmp(key, "cpu MHz") && !snap->processor_frequency)
+					snap->processor_frequency = strtod(val, NULL) * 1e6;
+
+				return !(snap->processor_name[0] && snap->processor_frequency);
+			});
+			/** most non-x86 cpuinfo has no "cpu MHz", cpufreq does **/
+			if (!snap->processor_frequency && cpu_sample_read(0, &cpu) == 0)
+				snap->processor_frequency = cpu.freq_cur * 1000;
+			return ret;
+		}
+		case SourceUtsname:
+			errno = 0;
+			if (uname(&snap->uts) != 0) {
+				perror("Failed to get umame data!!");
+				return -1;
+			}
+			return 0;
+		case SourceSysinfo:
+			errno = 0;
+			if (sysinfo(&snap->info) != 0) {
+				perror("Failed to get sysinfo!!");
+				return -1;
+			}
+			return 0;
+		case SourceScheduler:
+			snap->scheduler = sched_getscheduler(snap->pid);
+			errno = 0;
+			snap->priority = getpriority(PRIO_PROCESS, snap->pid);
+			if (errno != 0) {
+				perror("Failed to get process priority");
+				return -1;
+			}
+			return 0;
+		case SourceRlimit: {
+			int failed = 0, error = 0;
+
+			for (int t(VirtualMemory); t <= MaxStackSize; t++) {
+				int resource = rlimit_resource((Trait)t);
+
+				if (resource >= 0 && 
+				    prlimit(snap->pid, (__rlimit_resource)resource, NULL, 
+				            &snap->rlimits[t - VirtualMemory]) < 0) {
+					failed++;
+					error = errno;
+				}
+			}
+			/** a gone or foreign pid fails every limit, say so once **/
+			if (failed) {
+				errno = error;
+				perror("prlimit");
+			}
+			return failed == MaxStackSize - VirtualMemory + 1 ? -1 : 0;
+		}
+		case SourceMeminfo:
+			if (reader)
+				return reader->readMeminfo(snap->meminfo);
+			if ((len = proc_read_file("/proc/meminfo", buf, sizeof(buf))) < 0)
+				return -1;
+			return proc_meminfo_parse(buf, len, snap->meminfo);
+		case SourceStatus:
+			if (reader)
+				return reader->readStatus(&snap->status);
+			snprintf(path, sizeof(path), "/proc/%d/status", snap->pid);
+			if ((len = proc_read_file(path, buf, sizeof(buf))) < 0)
+				return -1;
+			return proc_status_parse(buf, len, &snap->status);
+		case SourceStat:
+			if (reader)
+				return reader->readStat(&snap->stat);
+			return proc_stat_init(&snap->stat, snap->pid);
+		case SourcePerf:
+			/** 
+			 * counts are only meaningful over time, a one-shot read
+			 * would open and close the group without counting
+			 */
+			if (reader)
+				return reader->readPerf(&snap->perf);
+			return -1;
+		case SourceNuma: {
+			std::vector< uint64_t > bytes;
+			const NumaTopology &topology = host_numa();
+
+			/** the home node comes from the stat processor field **/
+			if (snap->stat.pid != snap->pid && 
+			    read_source(snap, SourceStat, reader) < 0)
+				return -1;
+
+			snap->numa.local_bytes = snap->numa.remote_bytes = 0;
+			snap->numa.nodes = (int)topology.nodes().size();
+			snap->numa.home_node = 
+				topology.nodeOfCpu(snap->stat.processor_last_executed_on);
+			if (snap->numa.home_node >= 0) {
+				uint64_t total = 0;
+
+				topology.readMemory(snap->numa.home_node, &total, 
+				                    &snap->numa.home_node_free);
+			}
+			if (numa_maps_usage(snap->pid, buf, sizeof(buf), bytes) < 0)
+				return -1;
+			for (size_t n(0); n < bytes.size(); n++) {
+				if ((int)n == snap->numa.home_node)
+					snap->numa.local_bytes += bytes[n];
+				else
+					snap->numa.remote_bytes += bytes[n];
+			}
+			return 0;
+		}
+		case SourceCpu:
+			/** per cpu numbers are for the cpu the process last ran on **/
+			if (snap->stat.pid != snap->pid && 
+			    read_source(snap, SourceStat, reader) < 0)
+				return -1;
+			if (reader)
+				return reader->readCpu(snap->stat.processor_last_executed_on, 
+				                       &snap->cpu);
+			return cpu_sample_read(snap->stat.processor_last_executed_on, 
+			                       &snap->cpu);
+		case SourceSmaps:
+			/** the kernel walks the page tables of every mapping to build this **/
+			if (reader)
+				return reader->readSmaps(snap->smaps);
+			snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", snap->pid);
+			if ((len = proc_read_file(path, buf, sizeof(buf))) < 0)
+				return -1;
+			return proc_smaps_parse(buf, len, snap->smaps);
+		case SourceIO:
+			if (reader)
+				return reader->readIO(&snap->io);
+			snprintf(path, sizeof(path), "/proc/%d/io", snap->pid);
+			if ((len = proc_read_file(path, buf, sizeof(buf))) < 0)
+				return -1;
+			return proc_io_parse(buf, len, &snap->io);
+		case SourcePressure:
+			if (reader)
+				return reader->readPressure(snap->pressure);
+			return pressure_read_dir(PRESSURE_HOST_DIR, buf, sizeof(buf), snap->pressure);
+		case SourceCgroupPressure: {
+			char dir[PATH_MAX];
+
+			if (reader)
+				return reader->readCgroupPressure(snap->cgroup_pressure);
+			if (cgroup_dir(snap->pid, dir, sizeof(dir)) < 0)
+				return -1;
+			return pressure_read_dir(dir, buf, sizeof(buf), snap->cgroup_pressure);
+		}
+		case SourceCgroup: {
+			char dir[PATH_MAX];
+
+			if (reader)
+				return reader->readCgroup(&snap->cgroup);
+			if (cgroup_dir(snap->pid, dir, sizeof(dir)) < 0)
+				return -1;
+			return cgroup_read_dir(dir, buf, sizeof(buf), &snap->cgroup);
+		}
+		default:
+			break;
+	}
+
+	return -1;
+}
+
+/** the static cache relies on these never being re-read **/
+static_assert( trait_volatility( ProcessorName ) == StaticBoot, 
+               "ProcessorName must be cached" );
+static_assert( trait_volatility( UpTime ) == Sampled, 
+               "UpTime must be sampled" );
+static_assert( trait_volatility( ProcessorFrequency ) == Sampled, 
+               "ProcessorFrequency follows frequency scaling" );
+static_assert( CgroupPressureIOFullTotal - PressureCpuSomeAvg10 + 1 == 
+               2 * PRESSURE_RESOURCES * PRESSURE_TRAITS,
+               "getSnapshotValue indexes the Pressure traits by resource" );
+
+/**
+ * StaticCache - every StaticBoot trait, read once per process.
+ * base keeps the raw fields as well so snapshots can copy the
+ * sources that back nothing but static traits (sysconf) instead
+ * of re-reading them; complete[s] marks those sources.
+ */
+struct StaticCache{
+	struct SystemSnapshot base;
+	bool                  complete[SourceN];
+	TraitValue            values[N];
+};
+
+static const StaticCache &static_cache ()
+{
+	static StaticCache cache;
+	static std::once_flag once;
+
+	std::call_once(once, []() {
+		bool wanted[SourceN] = { false };
+
+		memset(&cache.base, 0, sizeof(struct SystemSnapshot));
+		cache.base.pid = getpid();
+		for (int s(0); s < SourceN; s++)
+			cache.complete[s] = true;
+
+		for (int t(0); t < N; t++) {
+			const Source source = trait_source((Trait)t);
+
+			if (trait_volatility((Trait)t) == StaticBoot)
+				wanted[source] = true;
+			else
+				cache.complete[source] = false;
+		}
+		for (int s(0); s < SourceN; s++) {
+			if (!wanted[s])
+				cache.complete[s] = false;
+			else if (read_source(&cache.base, (Source)s) < 0)
+				cache.complete[s] = false;
+		}
+		for (int t(0); t < N; t++) {
+			if (trait_volatility((Trait)t) == StaticBoot)
+				cache.values[t] = SystemInfo::getSnapshotValue((Trait)t, &cache.base);
+		}
+	});
+	return cache;
+}
+
+/**
+ * copy_static_source - copy source from the static cache.
+ * @return  bool - true if source is cached and was copied
+ */
+static bool copy_static_source (struct SystemSnapshot *snap, const Source source)
+{
+	const StaticCache &cache = static_cache();
+
+	if (!cache.complete[source])
+		return false;
+
+	switch (source) {
+		case SourceSysconf:
+			memcpy(snap->cache, cache.base.cache, sizeof(snap->cache));
+			snap->number_processors = cache.base.number_processors;
+			return true;
+		default:
+			return false;
+	}
+}
+
+uint64_t monotonic_ns ()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/** status and stat go away with the pid, a snapshot fails on them **/
+#define SOURCE_PROCESS ((1u << SourceStatus) | (1u << SourceStat))
+
+/**
+ * SOURCE_PER_PID - every source read from /proc/<pid> or keyed on
+ * the pid; host-wide sources (meminfo, PSI, ...) still read fine
+ * for a pid that exited.  Perf needs a ProcReader and can't be
+ * read one-shot, so its failure says nothing about the pid.
+ */
+#define SOURCE_PER_PID (SOURCE_PROCESS | (1u << SourceScheduler) | \
+                        (1u << SourceRlimit) | (1u << SourceNuma) | \
+                        (1u << SourceCpu) | (1u << SourceSmaps) | \
+                        (1u << SourceIO) | (1u << SourceCgroupPressure) | \
+                        (1u << SourceCgroup))
+
+/**
+ * fill_snapshot - read sources into snap.
+ * @param required - sources whose failure fails the snapshot
+ */
+static int fill_snapshot (struct SystemSnapshot *snap, int pid, ProcReader *reader,
+                          const uint32_t sources, const uint32_t required = SOURCE_PROCESS)
+{
+	int ret = 0;
+
+	if (!snap)
+		return -1;
+
+	memset(snap, 0, sizeof(struct SystemSnapshot));
+	snap->pid = pid;
+	snap->timestamp = monotonic_ns();
+
+	for (int s(0); s < SourceN; s++) {
+		if (!(sources & (1u << s)) || copy_static_source(snap, (Source)s))
+			continue;
+		if (read_source(snap, (Source)s, reader) < 0 && (required & (1u << s)))
+			ret = -1;
+	}
+
+	return ret;
+}
+
+int
+SystemInfo::snapshot (struct SystemSnapshot *snap, int pid)
+{
+	return fill_snapshot(snap, pid, NULL, SOURCE_ALL);
+}
+
+int
+SystemInfo::snapshot (struct SystemSnapshot *snap, int pid, const TraitSet &traits)
+{
+	return fill_snapshot(snap, pid, NULL, traits.sources());
+}
+
+int
+SystemInfo::snapshot (struct SystemSnapshot *snap, ProcReader *reader)
+{
+	if (!reader)
+		return -1;
+	return fill_snapshot(snap, reader->getPid(), reader, SOURCE_ALL);
+}
+
+int
+SystemInfo::snapshot (struct SystemSnapshot *snap, ProcReader *reader, 
+                      const TraitSet &traits)
+{
+	if (!reader)
+		return -1;
+	return fill_snapshot(snap, reader->getPid(), reader, traits.sources());
+}
+
+size_t
+SystemInfo::query (const TraitSet &traits, const int *pids, const size_t count, 
+                   std::vector< TraitValue > &out)
+{
+	const uint32_t sources = traits.sources();
+	struct SystemSnapshot snap;
+	std::vector< Trait > list;
+	size_t ok = 0;
+
+	for (int t(0); t < N; t++) {
+		if (traits.test((Trait)t))
+			list.push_back((Trait)t);
+	}
+
+	out.resize(count * list.size());
+	for (size_t p(0); p < count; p++) {
+		TraitValue *row = &out[p * list.size()];
+
+		if (fill_snapshot(&snap, pids[p], NULL, sources, SOURCE_PER_PID) < 0) {
+			for (size_t t(0); t < list.size(); t++)
+				row[t] = TraitValue();
+			continue;
+		}
+		for (size_t t(0); t < list.size(); t++)
+			row[t] = getSnapshotValue(list[t], &snap);
+		ok++;
+	}
+	return ok;
+}
+
+static Unit rlimit_unit (const Trait trait)
+{
+	switch (trait) {
+		case VirtualMemory:
+		case CoreFile:
+		case DataSegment:
+		case MaxFileSize:
+		case MaxMemLock:
+		case MsgQueueLimit:
+		case MaxStackSize:
+			return UnitBytes;
+		case CPUTime:
+			return UnitSeconds;
+		case MaxRTime:
+			return UnitMicroseconds;
+		default:
+			break;
+	}
+
+	return UnitCount;
+}
+
+static Unit cache_unit (const Trait trait)
+{
+	switch (trait) {
+		case LevelOneICacheAssociativity:
+		case LevelOneDCacheAssociativity:
+		case LevelTwoCacheAssociativity:
+		case LevelThreeCacheAssociativity:
+		case LevelFourCacheAssociativity:
+			return UnitCount;
+		default:
+			break;
+	}
+
+	return UnitBytes;
+}
+
+TraitValue
+SystemInfo::getSnapshotValue (const Trait trait, const struct SystemSnapshot *snap)
+{
+	if (trait <= LevelFourCacheLineSize) {
+		return int_value(snap->cache[trait], cache_unit(trait));
+	}
+	else if (trait == NumberOfProcessors) {
+		return uint_value(snap->number_processors, UnitCount);
+	}
+	else if (trait == ProcessorName) {
+		return string_value(snap->processor_name);
+	}
+	else if (trait == ProcessorFrequency) {
+		return uint_value(snap->processor_frequency, UnitHertz);
+	}
+	else if (SystemName <= trait && trait <= MachineName) {
+		return string_value(SystemInfo::utsname_to_string(trait, &snap->uts).c_str());
+	}
+	else if (UpTime <= trait && trait <= MemoryUnit) {
+		return SystemInfo::sysinfo_value(trait, &snap->info);
+	}
+	else if (trait == Scheduler) {
+		return string_value(schedule_str(snap->scheduler).c_str());
+	}
+	else if (trait == Priority) {
+		return int_value(snap->priority, UnitNone);
+	}
+	else if (trait >= VirtualMemory && trait <= MaxStackSize) {
+		/** RLIM_INFINITY comes back as -1, as it always has **/
+		return int_value((int64_t)snap->rlimits[trait - VirtualMemory].rlim_max,
+		                 rlimit_unit(trait));
+	}
+	else if (trait >= MemTotal && trait <= Hugepagesize) {
+		if (trait == HugePages_Total || trait == HugePages_Free)
+			return uint_value(snap->meminfo[trait - MemTotal], UnitCount);
+		return uint_value(snap->meminfo[trait - MemTotal], UnitKiloBytes);
+	}
+	else if (trait == voluntary_ctxt_switches) {
+		return uint_value(snap->status.voluntary_context_swaps, UnitCount);
+	}
+	else if (trait == nonvoluntary_ctxt_switches) {
+		return uint_value(snap->status.non_voluntary_context_swaps, UnitCount);
+	}
+	else if (trait >= pid1 && trait <= child_guest_time) {
+		return proc_stat_value(&snap->stat, trait);
+	}
+	else if (trait == PerfIPC) {
+		const int cycles = PerfCycles - PerfCycles, 
+		          instructions = PerfInstructions - PerfCycles;
+		TraitValue v;
+
+		if (!snap->perf.available[cycles] || !snap->perf.available[instructions] ||
+		    snap->perf.count[cycles] == 0)
+			return v;
+		v.type = TypeDouble;
+		v.d = (double)snap->perf.count[instructions] / snap->perf.count[cycles];
+		return v;
+	}
+	else if (trait >= PerfCycles && trait <= PerfCPUMigrations) {
+		if (!snap->perf.available[trait - PerfCycles])
+			return TraitValue();
+		return uint_value(snap->perf.count[trait - PerfCycles], 
+		                  trait == PerfTaskClock ? UnitNanoseconds : UnitCount);
+	}
+	else if (trait == NumaNodes) {
+		return uint_value(snap->numa.nodes, UnitCount);
+	}
+	else if (trait == NumaHomeNode) {
+		return int_value(snap->numa.home_node, UnitNone);
+	}
+	else if (trait == NumaHomeNodeMemFree) {
+		return uint_value(snap->numa.home_node_free, UnitKiloBytes);
+	}
+	else if (trait == NumaLocalMemory) {
+		return uint_value(snap->numa.local_bytes, UnitBytes);
+	}
+	else if (trait == NumaRemoteMemory) {
+		return uint_value(snap->numa.remote_bytes, UnitBytes);
+	}
+	else if (trait >= CpuUserTime && trait <= CpuStealTime) {
+		static const CpuStatField fields[] = {
+			CpuUser, CpuSystem, CpuIOWait, CpuIRQ, CpuSoftIRQ, CpuSteal
+		};
+
+		return uint_value(snap->cpu.time[fields[trait - CpuUserTime]], UnitTicks);
+	}
+	else if (trait == CpuFrequency) {
+		return uint_value(snap->cpu.freq_cur * 1000, UnitHertz);
+	}
+	else if (trait == CpuFrequencyMin) {
+		return uint_value(snap->cpu.freq_min * 1000, UnitHertz);
+	}
+	else if (trait == CpuFrequencyMax) {
+		return uint_value(snap->cpu.freq_max * 1000, UnitHertz);
+	}
+	else if (trait >= SmapsRss && trait <= SmapsLocked) {
+		return uint_value(snap->smaps[trait - SmapsRss], UnitKiloBytes);
+	}
+	else if (trait == rchar) {
+		return uint_value(snap->io.rchar, UnitBytes);
+	}
+	else if (trait == wchar) {
+		return uint_value(snap->io.wchar, UnitBytes);
+	}
+	else if (trait == syscr) {
+		return uint_value(snap->io.syscr, UnitCount);
+	}
+	else if (trait == syscw) {
+		return uint_value(snap->io.syscw, UnitCount);
+	}
+	else if (trait == read_bytes) {
+		return uint_value(snap->io.read_bytes, UnitBytes);
+	}
+	else if (trait == write_bytes) {
+		return uint_value(snap->io.write_bytes, UnitBytes);
+	}
+	else if (trait == cancelled_write_bytes) {
+		return uint_value(snap->io.cancelled_write_bytes, UnitBytes);
+	}
+	else if (trait >= PressureCpuSomeAvg10 && trait <= CgroupPressureIOFullTotal) {
+		const bool cgroup = (trait >= CgroupPressureCpuSomeAvg10);
+		const int offset = trait - (cgroup ? CgroupPressureCpuSomeAvg10 : PressureCpuSomeAvg10);
+		const struct PressureSample *sample = 
+			&(cgroup ? snap->cgroup_pressure : snap->pressure)[offset / PRESSURE_TRAITS];
+		const struct PressureLine *line = 
+			(offset % PRESSURE_TRAITS) < PRESSURE_TRAITS / 2 ? &sample->some : &sample->full;
+
+		switch (offset % (PRESSURE_TRAITS / 2)) {
+			case 0:
+				return double_value(line->avg10, UnitPercent);
+			case 1:
+				return double_value(line->avg60, UnitPercent);
+			case 2:
+				return double_value(line->avg300, UnitPercent);
+			default:
+				return uint_value(line->total, UnitMicroseconds);
+		}
+	}
+	else if (trait == CgroupMemoryCurrent) {
+		return uint_value(snap->cgroup.memory_current, UnitBytes);
+	}
+	else if (trait == CgroupMemoryMax) {
+		return int_value(snap->cgroup.memory_max, UnitBytes);
+	}
+	else if (trait >= CgroupMemory_anon && trait <= CgroupMemory_pgmajfault) {
+		return uint_value(snap->cgroup.memory[trait - CgroupMemory_anon], 
+		                  trait >= CgroupMemory_pgfault ? UnitCount : UnitBytes);
+	}
+	else if (trait == CgroupCpu_nr_periods || trait == CgroupCpu_nr_throttled) {
+		return uint_value(snap->cgroup.cpu[trait - CgroupCpu_usage_usec], UnitCount);
+	}
+	else if (trait >= CgroupCpu_usage_usec && trait <= CgroupCpu_throttled_usec) {
+		return uint_value(snap->cgroup.cpu[trait - CgroupCpu_usage_usec], 
+		                  UnitMicroseconds);
+	}
+	else if (trait == CgroupCpuMaxQuota) {
+		return int_value(snap->cgroup.cpu_quota, UnitMicroseconds);
+	}
+	else if (trait == CgroupCpuMaxPeriod) {
+		return uint_value(snap->cgroup.cpu_period, UnitMicroseconds);
+	}
+	else if (trait >= CgroupIO_rbytes && trait <= CgroupIO_dios) {
+		const bool bytes = (trait == CgroupIO_rbytes || trait == CgroupIO_wbytes || 
+		                    trait == CgroupIO_dbytes);
+
+		return uint_value(snap->cgroup.io[trait - CgroupIO_rbytes], 
+		                  bytes ? UnitBytes : UnitCount);
+	}
+
+	return TraitValue();
+}
+
+TraitValue
+SystemInfo::getSystemValue (const Trait trait, int pid)
+{
+	struct SystemSnapshot snap;
+
+	if (trait < N && trait_volatility(trait) == StaticBoot)
+		return static_cache().values[trait];
+
+	memset(&snap, 0, sizeof(struct SystemSnapshot));
+	snap.pid = pid;
+
+	if (trait >= N || read_source(&snap, trait_source(trait)) < 0)
+		return TraitValue();
+
+	return getSnapshotValue(trait, &snap);
+}
+
+std::string
+SystemInfo::getSnapshotProperty (const Trait trait, const struct SystemSnapshot *snap)
+{
+	return valueToString(getSnapshotValue(trait, snap));
+}
+#endif
+
+std::string
+SystemInfo::valueToString (const TraitValue &value)
+{
+	switch (value.type) {
+		case TypeUnsigned:
+			if (value.unit == UnitKiloBytes)
+				return std::to_string(value.u) + " kB";
+			return std::to_string(value.u);
+		case TypeSigned:
+			return std::to_string(value.i);
+		case TypeDouble:
+			return std::to_string(value.d);
+		case TypeString:
+			return value.s;
+		default:
+			break;
+	}
+
+	return std::to_string(0);
+}
+
+const char *
+SystemInfo::getUnitName (const Unit unit)
+{
+	static const char *unitStrings[UnitN] = {
+		"",
+		"B",
+		"kB",
+		"pages",
+		"ticks",
+		"s",
+		"us",
+		"Hz",
+		"count",
+		"mem_unit",
+		"load/65536",
+		"ns",
+		"%"};
+
+	return unitStrings[unit];
+}
+
 size_t
 SystemInfo::getNumTraits()
 {
@@ -942,35 +1637,41 @@ SystemInfo::getUTSNameInfo( const Trait t )
       {
          perror( "Failed to get umame data!!" );
       }
+      return( SystemInfo::utsname_to_string( t, &un ) );
+}
+
+std::string 
+SystemInfo::utsname_to_string( const Trait t, const struct utsname *un )
+{
       switch( t )
       {
          case( SystemName ):
          {
-            return( std::string( un.sysname ) );     
+            return( std::string( un->sysname ) );     
          }
          break;
          case( NodeName ):
          {
-            return( std::string( un.nodename ) );
+            return( std::string( un->nodename ) );
          }
          break;
          case( OSRelease ):
          {
-            return( std::string( un.release ) );
+            return( std::string( un->release ) );
          }
          break;
          case( OSVersion ):
          {
-            return( std::string( un.version ) );
+            return( std::string( un->version ) );
          }
          break;
          case( MachineName ):
          {
-            return( std::string( un.machine ) );
+            return( std::string( un->machine ) );
          }
          break;
          default:
             break;
       }
-      return( std::string( 0 ) );
+      return( std::string() );
 }
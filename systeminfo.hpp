@@ -20,13 +20,22 @@
 #ifndef _SYSTEMINFO_HPP_
 #define _SYSTEMINFO_HPP_  1
 #include <string>
+#include <cstdint>
+#include <bitset>
+#include <vector>
+#include <initializer_list>
+#include <sys/utsname.h>
+
+#if __linux
+#include <sys/sysinfo.h>
+#include <sys/resource.h>
+#endif
 
 /**
  * TODO list:
  * 1) Add getrlimit info
  * 2) Add /proc info such as context swap data, add option of specifying thread/proc id
  * 3) Add /proc/<pid>/stat info
- * 4) Add processor specific performance monitors, which will enable things like branch predictors,etc.
  */
 
 /**
@@ -38,7 +47,7 @@
  
 struct ProcStatData{
    int pid;
-   char executable[100];
+   char executable[100]; /* "(comm)" as it appears in stat, truncated to fit */
    char state;
    int parent_pid;
    int group_id;
@@ -87,6 +96,22 @@ struct ProcStatusData{
    int voluntary_context_swaps;
    int non_voluntary_context_swaps;
 }; 
+
+/**
+ * ProcIOData - the I/O counters of /proc/<pid>/io, cumulative over
+ * the life of the process.  The char counts are everything passed
+ * to read/write-like calls, page cache hits included; read_bytes
+ * and write_bytes are what was sent to the block layer.
+ */
+struct ProcIOData{
+   uint64_t rchar;
+   uint64_t wchar;
+   uint64_t syscr;
+   uint64_t syscw;
+   uint64_t read_bytes;
+   uint64_t write_bytes;
+   uint64_t cancelled_write_bytes;
+};
 enum Trait {
    LevelOneICacheSize = 0,
    LevelOneICacheAssociativity,
@@ -222,16 +247,472 @@ policy,
 delayed_io_ticks,
 guest_time,
 child_guest_time,	
+   PerfCycles,
+   PerfInstructions,
+   PerfIPC,
+   PerfCacheReferences,
+   PerfCacheMisses,
+   PerfBranchMisses,
+   PerfLLCLoads,
+   PerfTaskClock,
+   PerfPageFaults,
+   PerfContextSwitches,
+   PerfCPUMigrations,
+   NumaNodes,
+   NumaHomeNode,
+   NumaHomeNodeMemFree,
+   NumaLocalMemory,
+   NumaRemoteMemory,
+   CpuUserTime,
+   CpuSystemTime,
+   CpuIOWaitTime,
+   CpuIRQTime,
+   CpuSoftIRQTime,
+   CpuStealTime,
+   CpuFrequency,
+   CpuFrequencyMin,
+   CpuFrequencyMax,
+   SmapsRss,
+   SmapsPss,
+   SmapsPss_Dirty,
+   SmapsPss_Anon,
+   SmapsPss_File,
+   SmapsPss_Shmem,
+   SmapsShared_Clean,
+   SmapsShared_Dirty,
+   SmapsPrivate_Clean,
+   SmapsPrivate_Dirty,
+   SmapsReferenced,
+   SmapsAnonymous,
+   SmapsKSM,
+   SmapsLazyFree,
+   SmapsAnonHugePages,
+   SmapsShmemPmdMapped,
+   SmapsFilePmdMapped,
+   SmapsShared_Hugetlb,
+   SmapsPrivate_Hugetlb,
+   SmapsSwap,
+   SmapsSwapPss,
+   SmapsLocked,
+   rchar,
+   wchar,
+   syscr,
+   syscw,
+   read_bytes,
+   write_bytes,
+   cancelled_write_bytes,
+   PressureCpuSomeAvg10,
+   PressureCpuSomeAvg60,
+   PressureCpuSomeAvg300,
+   PressureCpuSomeTotal,
+   PressureCpuFullAvg10,
+   PressureCpuFullAvg60,
+   PressureCpuFullAvg300,
+   PressureCpuFullTotal,
+   PressureMemorySomeAvg10,
+   PressureMemorySomeAvg60,
+   PressureMemorySomeAvg300,
+   PressureMemorySomeTotal,
+   PressureMemoryFullAvg10,
+   PressureMemoryFullAvg60,
+   PressureMemoryFullAvg300,
+   PressureMemoryFullTotal,
+   PressureIOSomeAvg10,
+   PressureIOSomeAvg60,
+   PressureIOSomeAvg300,
+   PressureIOSomeTotal,
+   PressureIOFullAvg10,
+   PressureIOFullAvg60,
+   PressureIOFullAvg300,
+   PressureIOFullTotal,
+   CgroupPressureCpuSomeAvg10,
+   CgroupPressureCpuSomeAvg60,
+   CgroupPressureCpuSomeAvg300,
+   CgroupPressureCpuSomeTotal,
+   CgroupPressureCpuFullAvg10,
+   CgroupPressureCpuFullAvg60,
+   CgroupPressureCpuFullAvg300,
+   CgroupPressureCpuFullTotal,
+   CgroupPressureMemorySomeAvg10,
+   CgroupPressureMemorySomeAvg60,
+   CgroupPressureMemorySomeAvg300,
+   CgroupPressureMemorySomeTotal,
+   CgroupPressureMemoryFullAvg10,
+   CgroupPressureMemoryFullAvg60,
+   CgroupPressureMemoryFullAvg300,
+   CgroupPressureMemoryFullTotal,
+   CgroupPressureIOSomeAvg10,
+   CgroupPressureIOSomeAvg60,
+   CgroupPressureIOSomeAvg300,
+   CgroupPressureIOSomeTotal,
+   CgroupPressureIOFullAvg10,
+   CgroupPressureIOFullAvg60,
+   CgroupPressureIOFullAvg300,
+   CgroupPressureIOFullTotal,
+   CgroupMemoryCurrent,
+   CgroupMemoryMax,
+   CgroupMemory_anon,
+   CgroupMemory_file,
+   CgroupMemory_kernel,
+   CgroupMemory_kernel_stack,
+   CgroupMemory_pagetables,
+   CgroupMemory_sock,
+   CgroupMemory_shmem,
+   CgroupMemory_file_mapped,
+   CgroupMemory_file_dirty,
+   CgroupMemory_file_writeback,
+   CgroupMemory_anon_thp,
+   CgroupMemory_inactive_anon,
+   CgroupMemory_active_anon,
+   CgroupMemory_inactive_file,
+   CgroupMemory_active_file,
+   CgroupMemory_unevictable,
+   CgroupMemory_slab_reclaimable,
+   CgroupMemory_slab_unreclaimable,
+   CgroupMemory_pgfault,
+   CgroupMemory_pgmajfault,
+   CgroupCpu_usage_usec,
+   CgroupCpu_user_usec,
+   CgroupCpu_system_usec,
+   CgroupCpu_nr_periods,
+   CgroupCpu_nr_throttled,
+   CgroupCpu_throttled_usec,
+   CgroupCpuMaxQuota,
+   CgroupCpuMaxPeriod,
+   CgroupIO_rbytes,
+   CgroupIO_wbytes,
+   CgroupIO_rios,
+   CgroupIO_wios,
+   CgroupIO_dbytes,
+   CgroupIO_dios,
 #endif
    N
 };
 
+#if __linux
+/** number of slots in PerfSample, PerfCycles through PerfCPUMigrations **/
+#define PERF_TRAITS (PerfCPUMigrations - PerfCycles + 1)
+
+/**
+ * PerfSample - counts of the perf_event groups a ProcReader keeps
+ * on the threads of its pid, cumulative since they were opened,
+ * each thread scaled up by its time_enabled / time_running if the
+ * PMU was multiplexed, then summed.  The times are summed over
+ * the threads as well.  hardware is false when the PMU could not be used (VMs,
+ * containers, perf_event_paranoid) and only the software events
+ * were counted.  available[i] says whether slot i was counted.
+ */
+struct PerfSample{
+   bool     hardware;
+   uint64_t time_enabled; /* ns */
+   uint64_t time_running; /* ns */
+   uint64_t count[PERF_TRAITS];
+   bool     available[PERF_TRAITS];
+};
+
+/**
+ * NumaSample - where a process' memory sits relative to its home
+ * node, the node of the cpu it last ran on.
+ */
+struct NumaSample{
+   int      nodes;
+   int      home_node;
+   uint64_t home_node_free; /* kB */
+   uint64_t local_bytes;    /* resident on the home node */
+   uint64_t remote_bytes;   /* resident on any other node */
+};
+
+/** columns of a cpuN line in /proc/stat, in kernel order **/
+#define CPU_STAT_FIELDS 8
+enum CpuStatField{
+   CpuUser = 0,
+   CpuNice,
+   CpuSystem,
+   CpuIdle,
+   CpuIOWait,
+   CpuIRQ,
+   CpuSoftIRQ,
+   CpuSteal
+};
+
+/**
+ * CpuSample - cumulative jiffies of one cpu from /proc/stat and
+ * its cpufreq policy.  Frequencies are in kHz as sysfs reports
+ * them and are 0 when the cpu has no cpufreq driver.
+ */
+struct CpuSample{
+   int      cpu;
+   uint64_t time[CPU_STAT_FIELDS]; /* ticks */
+   uint64_t freq_cur;
+   uint64_t freq_min;
+   uint64_t freq_max;
+};
+
+/** number of smaps fields, SmapsRss through SmapsLocked **/
+#define SMAPS_FIELDS (SmapsLocked - SmapsRss + 1)
+
+/** resources with Pressure Stall Information, in Trait order **/
+#define PRESSURE_RESOURCES 3
+/** traits per resource, avg10, avg60, avg300 and total of some then full **/
+#define PRESSURE_TRAITS 8
+enum PressureResource{
+   PressureCpu = 0,
+   PressureMemory,
+   PressureIO
+};
+
+/**
+ * PressureLine - one line of a PSI file: the share of time, in
+ * percent, that tasks stalled on the resource over the last 10,
+ * 60 and 300 seconds, and the total stall time.
+ */
+struct PressureLine{
+   double   avg10;
+   double   avg60;
+   double   avg300;
+   uint64_t total; /* us */
+};
+
+/**
+ * PressureSample - a PSI file.  some is time at least one task
+ * stalled, full time all non-idle tasks stalled at once.  The
+ * kernel reports full for cpu as zeros outside cgroups.
+ */
+struct PressureSample{
+   struct PressureLine some;
+   struct PressureLine full;
+};
+
+/** fields of memory.stat, cpu.stat and io.stat kept, in Trait order **/
+#define CGROUP_MEMORY_FIELDS (CgroupMemory_pgmajfault - CgroupMemory_anon + 1)
+#define CGROUP_CPU_FIELDS    (CgroupCpu_throttled_usec - CgroupCpu_usage_usec + 1)
+#define CGROUP_IO_FIELDS     (CgroupIO_dios - CgroupIO_rbytes + 1)
+
+/**
+ * CgroupSample - accounting of a v2 cgroup, what the processes in
+ * it use against its own limits rather than the host's.  Limits
+ * are -1 when set to "max".  io is summed over all devices.  A
+ * controller that isn't enabled for the cgroup reads as zeros;
+ * cpu.stat's usage, user and system are always there.
+ */
+struct CgroupSample{
+   uint64_t memory_current;                     /* bytes */
+   int64_t  memory_max;                         /* bytes */
+   uint64_t memory[CGROUP_MEMORY_FIELDS];       /* bytes, pgfault and pgmajfault counts */
+   uint64_t cpu[CGROUP_CPU_FIELDS];             /* us, nr_* counts */
+   int64_t  cpu_quota;                          /* us per period */
+   uint64_t cpu_period;                         /* us */
+   uint64_t io[CGROUP_IO_FIELDS];               /* bytes, *ios counts */
+};
+#endif
+
+/**
+ * ValueType - tag for the active member of a TraitValue.
+ */
+enum ValueType {
+   TypeNone = 0,
+   TypeUnsigned,
+   TypeSigned,
+   TypeDouble,
+   TypeString
+};
+
+/**
+ * Unit - unit the number in a TraitValue is expressed in, so
+ * callers can scale without knowing where the trait came from.
+ * UnitMemoryUnits are multiples of the MemoryUnit trait and
+ * UnitLoadFixed is the sysinfo load average scaled by 65536.
+ */
+enum Unit {
+   UnitNone = 0,
+   UnitBytes,
+   UnitKiloBytes,
+   UnitPages,
+   UnitTicks,
+   UnitSeconds,
+   UnitMicroseconds,
+   UnitHertz,
+   UnitCount,
+   UnitMemoryUnits,
+   UnitLoadFixed,
+   UnitNanoseconds,
+   UnitPercent,
+   UnitN
+};
+
+/**
+ * TraitValue - typed value of a single trait.  Only s
+ * allocates, and only for the handful of string traits.
+ */
+struct TraitValue{
+   ValueType type;
+   Unit      unit;
+   union {
+      uint64_t u;
+      int64_t  i;
+      double   d;
+   };
+   std::string s;
+
+   TraitValue() : type( TypeNone ), unit( UnitNone ), u( 0 ) {}
+};
+
+/**
+ * Volatility - StaticBoot traits can't change while the process
+ * runs (cache geometry, cpu model, kernel release, page sizes)
+ * and are read once, Sampled traits are read on every query.
+ * ProcessorFrequency follows frequency scaling and is Sampled.
+ */
+enum Volatility {
+   Sampled = 0,
+   StaticBoot
+};
+
+constexpr Volatility trait_volatility (const Trait trait)
+{
+   return( ( trait <= NumberOfProcessors ||
+             trait == ProcessorName      ||
+             trait == SystemName         ||
+             trait == OSRelease          ||
+             trait == OSVersion          ||
+             trait == MachineName        ||
+             trait == MemoryUnit
+#ifdef __linux
+             || trait == VMallocTotal
+             || trait == Hugepagesize
+#endif
+           ) ? StaticBoot : Sampled );
+}
+
+#if __linux
+class ProcReader;
+
+/**
+ * Source - the distinct places traits are read from.  Each source
+ * is one file or call; reading any trait of a source reads all of
+ * it, so this is the unit a TraitSet saves work in.
+ */
+enum Source {
+   SourceSysconf = 0,
+   SourceCpuinfo,
+   SourceUtsname,
+   SourceSysinfo,
+   SourceScheduler,
+   SourceRlimit,
+   SourceMeminfo,
+   SourceStatus,
+   SourceStat,
+   SourcePerf,
+   SourceNuma,
+   SourceCpu,
+   SourceSmaps,
+   SourceIO,
+   SourcePressure,
+   SourceCgroupPressure,
+   SourceCgroup,
+   SourceN
+};
+
+/** all sources as a bit mask, bit s for Source s **/
+#define SOURCE_ALL ((1u << SourceN) - 1)
+/** all but Perf, its groups cost fds on every thread and are opt-in **/
+#define SOURCE_DEFAULT (SOURCE_ALL & ~(1u << SourcePerf))
+
+/**
+ * trait_source - the source trait is served from.  The Numa and
+ * Cpu sources also need the pid's stat, which they read themselves
+ * when it isn't in the snapshot yet.
+ */
+Source trait_source (const Trait trait);
+
+/**
+ * TraitSet - a set of traits, one bit per Trait.  Handed to
+ * SystemInfo::snapshot() or query() so that only the sources
+ * backing those traits are opened and parsed.  Cheap enough to
+ * build once and keep as a static const.
+ */
+class TraitSet
+{
+public:
+   TraitSet() {}
+   TraitSet( std::initializer_list< Trait > traits )
+   {
+      for( const Trait t : traits )
+      {
+         bits.set( t );
+      }
+   }
+
+   TraitSet &set (const Trait t) { bits.set(t); return *this; }
+   TraitSet &reset (const Trait t) { bits.reset(t); return *this; }
+   bool test (const Trait t) const { return bits.test(t); }
+   size_t count () const { return bits.count(); }
+   bool empty () const { return bits.none(); }
+
+   static TraitSet all () { TraitSet s; s.bits.set(); return s; }
+
+   /**
+    * defaults - every trait but the Perf* ones, see SOURCE_DEFAULT.
+    */
+   static TraitSet defaults ();
+
+   /**
+    * sources - bit mask of the Sources the traits are read from.
+    */
+   uint32_t sources () const;
+
+private:
+   std::bitset< N > bits;
+};
+
+/**
+ * SystemSnapshot - one sample of every source the traits are
+ * served from.  SystemInfo::snapshot() reads each source exactly
+ * once (sysconf, cpuinfo, utsname, sysinfo, rlimits, meminfo and
+ * the pid's status and stat files) so that a full pass over the
+ * traits costs one read per source instead of one per trait.
+ */
+struct SystemSnapshot{
+   int pid;
+   uint64_t timestamp; /* CLOCK_MONOTONIC ns when the sample was started */
+   long cache[LevelFourCacheLineSize + 1]; /* sysconf values, -1 if unknown */
+   int number_processors;
+   char processor_name[128];
+   uint64_t processor_frequency; /* Hz */
+   struct utsname uts;
+   struct sysinfo info;
+   int scheduler;
+   int priority;
+   struct rlimit rlimits[MaxStackSize - VirtualMemory + 1];
+   uint64_t meminfo[Hugepagesize - MemTotal + 1]; /* kB, or page counts for HugePages_* */
+   struct ProcStatusData status;
+   struct ProcStatData stat;
+   struct PerfSample perf; /* only filled through a ProcReader */
+   struct NumaSample numa;
+   struct CpuSample  cpu;  /* the cpu the process last ran on */
+   uint64_t smaps[SMAPS_FIELDS]; /* kB, from smaps_rollup */
+   struct ProcIOData io;
+   struct PressureSample pressure[PRESSURE_RESOURCES];        /* host */
+   struct PressureSample cgroup_pressure[PRESSURE_RESOURCES]; /* the pid's cgroup */
+   struct CgroupSample   cgroup;
+};
+#endif
+
 int getrlimit_trait (const Trait trait);
+int rlimit_resource (const Trait trait);
+uint64_t monotonic_ns ();
 std::string schedule_str (const int schedule);
 int cache_handle (const Trait trait);
 int parse_named_value (const char *path, const char *name, char *buf);
 std::string cstr_to_string (const char *cstr);
 
+/**
+ * SystemInfo - stateless entry points.  Every call works on the
+ * snapshot or pid it is handed; the only shared state is the
+ * read-once static trait and topology caches, so any member may
+ * be called from several threads at once.  Callers that sample
+ * the same pid repeatedly should keep a SystemContext.
+ */
 class SystemInfo
 {
 public:
@@ -239,6 +720,7 @@ public:
    virtual ~SystemInfo()   = delete;
 
    static std::string sysinfo_to_string (const Trait trait, struct sysinfo info);
+   static TraitValue  sysinfo_value (const Trait trait, const struct sysinfo *info);
 
    /**
     * getSystemProperty - call with a trait from the enum defined
@@ -249,8 +731,95 @@ public:
     * @return  - std::string representation of the system property
     */
    static std::string getSystemProperty (const Trait trait, int pid);
+
+   /**
+    * valueToString - format a TraitValue the way getSystemProperty
+    * always has; kB valued traits keep their " kB" suffix.
+    * @param value - const TraitValue &
+    * @return  - std::string
+    */
+   static std::string valueToString (const TraitValue &value);
+
+   /**
+    * getUnitName - short printable name of a Unit, "" for UnitNone.
+    * @param unit - const Unit
+    * @return  const char *
+    */
+   static const char *getUnitName (const Unit unit);
+
+#if __linux
+   /**
+    * snapshot - read every trait source once for the given pid
+    * and fill snap.  Host-wide sources are always filled; the
+    * return value is -1 if the per-process sources for pid could
+    * not be read (e.g. the process has exited), 0 otherwise.
+    * @param snap - struct SystemSnapshot to fill
+    * @param pid - process to sample
+    * @return  int - 0 on success, -1 on failure
+    */
+   static int snapshot (struct SystemSnapshot *snap, int pid);
+
+   /**
+    * snapshot - same as above but the stat, status and meminfo
+    * sources are refreshed through reader's already open fds.
+    * @param snap - struct SystemSnapshot to fill
+    * @param reader - ProcReader opened on the pid to sample
+    * @return  int - 0 on success, -1 on failure
+    */
+   static int snapshot (struct SystemSnapshot *snap, ProcReader *reader);
+
+   /**
+    * snapshot - same as the two above but only the sources backing
+    * traits are read; every other field of snap is left zeroed.
+    * @param traits - const TraitSet & of the traits wanted
+    */
+   static int snapshot (struct SystemSnapshot *snap, int pid, const TraitSet &traits);
+   static int snapshot (struct SystemSnapshot *snap, ProcReader *reader, 
+                        const TraitSet &traits);
+
+   /**
+    * query - the traits of every pid in pids, reading only the
+    * sources those traits need.  out is resized to count rows of
+    * traits.count() values each, in Trait order; a pid that could
+    * not be read gets a row of TypeNone values.  Any per-pid source
+    * the traits need failing counts as not read, host-wide ones
+    * (meminfo, PSI, ...) don't.
+    * @return  size_t - number of pids read
+    */
+   static size_t query (const TraitSet &traits, const int *pids, const size_t count,
+                        std::vector< TraitValue > &out);
+
+   /**
+    * getSnapshotProperty - same as getSystemProperty but served
+    * from a snapshot filled by snapshot() instead of re-reading
+    * the underlying source.
+    * @param trait - const Trait
+    * @param snap - const struct SystemSnapshot *
+    * @return  - std::string representation of the system property
+    */
+   static std::string getSnapshotProperty (const Trait trait, 
+                                           const struct SystemSnapshot *snap);
+
+   /**
+    * getSystemValue - typed form of getSystemProperty, reads only
+    * the source backing trait.  Returns a TypeNone value if the
+    * source could not be read.
+    * @param trait - const Trait
+    * @param pid - process to sample for per-process traits
+    * @return  TraitValue
+    */
+   static TraitValue getSystemValue (const Trait trait, int pid);
+
+   /**
+    * getSnapshotValue - typed form of getSnapshotProperty.
+    * @param trait - const Trait
+    * @param snap - const struct SystemSnapshot *
+    * @return  TraitValue
+    */
+   static TraitValue getSnapshotValue (const Trait trait, 
+                                       const struct SystemSnapshot *snap);
+#endif
    
-   static struct ProcStatData data;
    /**
     * getName - raturn the string name of the trait passed in
     * by the parameter.
@@ -340,9 +909,9 @@ public:
 		"PageTables",
 		"CommitLimit",
 		"Committed_AS",
-		"VMallocTotal",
-		"VMallocUsed",
-		"VMallocChunk",
+		"VmallocTotal",
+		"VmallocUsed",
+		"VmallocChunk",
 		"HardwareCorrupted",
 		"AnonHugePages",
 		"HugePages_Total",
@@ -392,7 +961,145 @@ public:
 "policy",
 "delayed_io_ticks",
 "guest_time",
-"child_guest_time"};
+"child_guest_time",
+		"PerfCycles",
+		"PerfInstructions",
+		"PerfIPC",
+		"PerfCacheReferences",
+		"PerfCacheMisses",
+		"PerfBranchMisses",
+		"PerfLLCLoads",
+		"PerfTaskClock",
+		"PerfPageFaults",
+		"PerfContextSwitches",
+		"PerfCPUMigrations",
+		"NumaNodes",
+		"NumaHomeNode",
+		"NumaHomeNodeMemFree",
+		"NumaLocalMemory",
+		"NumaRemoteMemory",
+		"CpuUserTime",
+		"CpuSystemTime",
+		"CpuIOWaitTime",
+		"CpuIRQTime",
+		"CpuSoftIRQTime",
+		"CpuStealTime",
+		"CpuFrequency",
+		"CpuFrequencyMin",
+		"CpuFrequencyMax",
+		"SmapsRss",
+		"SmapsPss",
+		"SmapsPss_Dirty",
+		"SmapsPss_Anon",
+		"SmapsPss_File",
+		"SmapsPss_Shmem",
+		"SmapsShared_Clean",
+		"SmapsShared_Dirty",
+		"SmapsPrivate_Clean",
+		"SmapsPrivate_Dirty",
+		"SmapsReferenced",
+		"SmapsAnonymous",
+		"SmapsKSM",
+		"SmapsLazyFree",
+		"SmapsAnonHugePages",
+		"SmapsShmemPmdMapped",
+		"SmapsFilePmdMapped",
+		"SmapsShared_Hugetlb",
+		"SmapsPrivate_Hugetlb",
+		"SmapsSwap",
+		"SmapsSwapPss",
+		"SmapsLocked",
+		"rchar",
+		"wchar",
+		"syscr",
+		"syscw",
+		"read_bytes",
+		"write_bytes",
+		"cancelled_write_bytes",
+		"PressureCpuSomeAvg10",
+		"PressureCpuSomeAvg60",
+		"PressureCpuSomeAvg300",
+		"PressureCpuSomeTotal",
+		"PressureCpuFullAvg10",
+		"PressureCpuFullAvg60",
+		"PressureCpuFullAvg300",
+		"PressureCpuFullTotal",
+		"PressureMemorySomeAvg10",
+		"PressureMemorySomeAvg60",
+		"PressureMemorySomeAvg300",
+		"PressureMemorySomeTotal",
+		"PressureMemoryFullAvg10",
+		"PressureMemoryFullAvg60",
+		"PressureMemoryFullAvg300",
+		"PressureMemoryFullTotal",
+		"PressureIOSomeAvg10",
+		"PressureIOSomeAvg60",
+		"PressureIOSomeAvg300",
+		"PressureIOSomeTotal",
+		"PressureIOFullAvg10",
+		"PressureIOFullAvg60",
+		"PressureIOFullAvg300",
+		"PressureIOFullTotal",
+		"CgroupPressureCpuSomeAvg10",
+		"CgroupPressureCpuSomeAvg60",
+		"CgroupPressureCpuSomeAvg300",
+		"CgroupPressureCpuSomeTotal",
+		"CgroupPressureCpuFullAvg10",
+		"CgroupPressureCpuFullAvg60",
+		"CgroupPressureCpuFullAvg300",
+		"CgroupPressureCpuFullTotal",
+		"CgroupPressureMemorySomeAvg10",
+		"CgroupPressureMemorySomeAvg60",
+		"CgroupPressureMemorySomeAvg300",
+		"CgroupPressureMemorySomeTotal",
+		"CgroupPressureMemoryFullAvg10",
+		"CgroupPressureMemoryFullAvg60",
+		"CgroupPressureMemoryFullAvg300",
+		"CgroupPressureMemoryFullTotal",
+		"CgroupPressureIOSomeAvg10",
+		"CgroupPressureIOSomeAvg60",
+		"CgroupPressureIOSomeAvg300",
+		"CgroupPressureIOSomeTotal",
+		"CgroupPressureIOFullAvg10",
+		"CgroupPressureIOFullAvg60",
+		"CgroupPressureIOFullAvg300",
+		"CgroupPressureIOFullTotal",
+		"CgroupMemoryCurrent",
+		"CgroupMemoryMax",
+		"CgroupMemory_anon",
+		"CgroupMemory_file",
+		"CgroupMemory_kernel",
+		"CgroupMemory_kernel_stack",
+		"CgroupMemory_pagetables",
+		"CgroupMemory_sock",
+		"CgroupMemory_shmem",
+		"CgroupMemory_file_mapped",
+		"CgroupMemory_file_dirty",
+		"CgroupMemory_file_writeback",
+		"CgroupMemory_anon_thp",
+		"CgroupMemory_inactive_anon",
+		"CgroupMemory_active_anon",
+		"CgroupMemory_inactive_file",
+		"CgroupMemory_active_file",
+		"CgroupMemory_unevictable",
+		"CgroupMemory_slab_reclaimable",
+		"CgroupMemory_slab_unreclaimable",
+		"CgroupMemory_pgfault",
+		"CgroupMemory_pgmajfault",
+		"CgroupCpu_usage_usec",
+		"CgroupCpu_user_usec",
+		"CgroupCpu_system_usec",
+		"CgroupCpu_nr_periods",
+		"CgroupCpu_nr_throttled",
+		"CgroupCpu_throttled_usec",
+		"CgroupCpuMaxQuota",
+		"CgroupCpuMaxPeriod",
+		"CgroupIO_rbytes",
+		"CgroupIO_wbytes",
+		"CgroupIO_rios",
+		"CgroupIO_wios",
+		"CgroupIO_dbytes",
+		"CgroupIO_dios"};
 
 	return traitStrings[trait];
 }
@@ -412,5 +1119,14 @@ protected:
     */
    static std::string   getUTSNameInfo( const Trait t );
 
+   /**
+    * utsname_to_string - pick the field for trait t out of an
+    * already filled utsname struct.
+    * @param t - const Trait
+    * @param un - const struct utsname *
+    * @return  - std::string - string representation of sytem property
+    */
+   static std::string   utsname_to_string( const Trait t, const struct utsname *un );
+
 };
 #endif /* END _SYSTEMINFO_HPP_ */
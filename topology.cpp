@@ -0,0 +1,445 @@
+/**
+ * topology.cpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <sys/sysinfo.h>
+
+#include "topology.hpp"
+#include "procparse.hpp"
+
+#define SYSFS_CPU  "/sys/devices/system/cpu"
+#define SYSFS_NODE "/sys/devices/system/node"
+
+int parse_cpu_list (const char *list, std::vector< int > &ids)
+{
+	const char *p = list;
+
+	while (*p && *p != '\n') {
+		char *end;
+		long first, last;
+
+		first = strtol(p, &end, 10);
+		if (end == p || first < 0)
+			return -1;
+		last = first;
+		p = end;
+		if (*p == '-') {
+			last = strtol(p + 1, &end, 10);
+			if (end == p + 1 || last < first)
+				return -1;
+			p = end;
+		}
+		for (long id(first); id <= last; id++)
+			ids.push_back((int)id);
+		if (*p == ',')
+			p++;
+	}
+
+	return 0;
+}
+
+/** read a small sysfs attribute, trailing newline stripped **/
+static int read_attr (const char *path, char *buf, const size_t size)
+{
+	ssize_t len;
+
+	if ((len = proc_read_file(path, buf, size)) < 0)
+		return -1;
+	while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == ' '))
+		buf[--len] = '\0';
+	return 0;
+}
+
+/** sysfs sizes look like "48K", "2048K" or "32M" **/
+static uint64_t parse_size (const char *str)
+{
+	char *end;
+	uint64_t size = strtoull(str, &end, 10);
+
+	switch (*end) {
+		case 'K':
+			return size << 10;
+		case 'M':
+			return size << 20;
+		case 'G':
+			return size << 30;
+		default:
+			break;
+	}
+	return size;
+}
+
+int
+CacheTopology::loadCpu (const int cpu)
+{
+	char path[128], buf[1024];
+
+	if ((size_t)cpu >= per_cpu.size())
+		per_cpu.resize(cpu + 1);
+	per_cpu[cpu].clear();
+
+	for (int index(0); ; index++) {
+		CacheInfo info;
+
+		snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cache/index%d/level", cpu, index);
+		if (read_attr(path, buf, sizeof(buf)) < 0)
+			break;
+		info.level = atoi(buf);
+
+		snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cache/index%d/type", cpu, index);
+		if (read_attr(path, buf, sizeof(buf)) < 0)
+			continue;
+		if (!strcmp(buf, "Instruction"))
+			info.type = CacheInstruction;
+		else if (!strcmp(buf, "Data"))
+			info.type = CacheData;
+		else if (!strcmp(buf, "Unified"))
+			info.type = CacheUnified;
+		else
+			continue;
+
+		snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cache/index%d/size", cpu, index);
+		info.size = read_attr(path, buf, sizeof(buf)) < 0 ? 0 : parse_size(buf);
+
+		snprintf(path, sizeof(path), 
+		         SYSFS_CPU "/cpu%d/cache/index%d/ways_of_associativity", cpu, index);
+		info.ways = read_attr(path, buf, sizeof(buf)) < 0 ? 0 : atoi(buf);
+
+		snprintf(path, sizeof(path), 
+		         SYSFS_CPU "/cpu%d/cache/index%d/coherency_line_size", cpu, index);
+		info.line_size = read_attr(path, buf, sizeof(buf)) < 0 ? 0 : atoi(buf);
+
+		snprintf(path, sizeof(path), 
+		         SYSFS_CPU "/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+		if (read_attr(path, buf, sizeof(buf)) == 0)
+			parse_cpu_list(buf, info.shared_cpus);
+
+		per_cpu[cpu].push_back(info);
+	}
+
+	return per_cpu[cpu].empty() ? -1 : 0;
+}
+
+int
+CacheTopology::load (const int cpu)
+{
+	char buf[1024];
+	std::vector< int > online;
+	int found = 0;
+
+	cpu_ids.clear();
+	per_cpu.clear();
+
+	if (cpu >= 0)
+		online.push_back(cpu);
+	else if (read_attr(SYSFS_CPU "/online", buf, sizeof(buf)) < 0 ||
+	         parse_cpu_list(buf, online) < 0)
+		return -1;
+
+	for (size_t i(0); i < online.size(); i++) {
+		cpu_ids.push_back(online[i]);
+		if (loadCpu(online[i]) == 0)
+			found++;
+	}
+
+	return found ? 0 : -1;
+}
+
+const std::vector< CacheInfo > &
+CacheTopology::caches (const int cpu) const
+{
+	static const std::vector< CacheInfo > none;
+
+	if (cpu < 0 || (size_t)cpu >= per_cpu.size())
+		return none;
+	return per_cpu[cpu];
+}
+
+const CacheInfo *
+CacheTopology::find (const int cpu, const int level, const CacheType type) const
+{
+	const std::vector< CacheInfo > &list = caches(cpu);
+
+	for (size_t i(0); i < list.size(); i++) {
+		if (list[i].level != level)
+			continue;
+		if (type == CacheInstruction ? list[i].type == CacheInstruction 
+		                             : list[i].type != CacheInstruction)
+			return &list[i];
+	}
+
+	return NULL;
+}
+
+std::vector< int >
+CacheTopology::sharing (const int cpu, const int level) const
+{
+	const CacheInfo *info = find(cpu, level);
+
+	if (!info)
+		return std::vector< int >();
+	return info->shared_cpus;
+}
+
+long
+CacheTopology::traitValue (const Trait trait, const int cpu) const
+{
+	const CacheInfo *info = NULL;
+
+	switch (trait) {
+		case LevelOneICacheSize:
+		case LevelOneICacheAssociativity:
+		case LevelOneICacheLineSize:
+			info = find(cpu, 1, CacheInstruction);
+			break;
+		case LevelOneDCacheSize:
+		case LevelOneDCacheAssociativity:
+		case LevelOneDCacheLineSize:
+			info = find(cpu, 1);
+			break;
+		case LevelTwoCacheSize:
+		case LevelTwoCacheAssociativity:
+		case LevelTwoCacheLineSize:
+			info = find(cpu, 2);
+			break;
+		case LevelThreeCacheSize:
+		case LevelThreeCacheAssociativity:
+		case LevelThreeCacheLineSize:
+			info = find(cpu, 3);
+			break;
+		case LevelFourCacheSize:
+		case LevelFourCacheAssociativity:
+		case LevelFourCacheLineSize:
+			info = find(cpu, 4);
+			break;
+		default:
+			break;
+	}
+
+	if (!info)
+		return -1;
+
+	switch (trait) {
+		case LevelOneICacheSize:
+		case LevelOneDCacheSize:
+		case LevelTwoCacheSize:
+		case LevelThreeCacheSize:
+		case LevelFourCacheSize:
+			return (long)info->size;
+		case LevelOneICacheAssociativity:
+		case LevelOneDCacheAssociativity:
+		case LevelTwoCacheAssociativity:
+		case LevelThreeCacheAssociativity:
+		case LevelFourCacheAssociativity:
+			return info->ways;
+		default:
+			break;
+	}
+
+	return info->line_size;
+}
+
+int
+NumaTopology::readMemory (const int node, uint64_t *total, uint64_t *free) const
+{
+	char path[128], buf[PROC_BUFFER_SIZE];
+	ssize_t len;
+
+	if (!has_sysfs) {
+		struct sysinfo info;
+
+		if (sysinfo(&info) != 0)
+			return -1;
+		*total = (uint64_t)info.totalram * info.mem_unit >> 10;
+		*free = (uint64_t)info.freeram * info.mem_unit >> 10;
+		return 0;
+	}
+
+	snprintf(path, sizeof(path), SYSFS_NODE "/node%d/meminfo", node);
+	if ((len = proc_read_file(path, buf, sizeof(buf))) < 0)
+		return -1;
+
+	/** keys read "Node 0 MemFree", only the last word matters **/
+	for_each_named_line(buf, len, [&](const char *key, size_t key_len, const char *val) {
+		const char *name = key + key_len;
+
+		while (name > key && name[-1] != ' ')
+			name--;
+		key_len -= name - key;
+		if (key_len == 8 && !memcmp(name, "MemTotal", 8))
+			*total = strtoull(val, NULL, 10);
+		else if (key_len == 7 && !memcmp(name, "MemFree", 7)) {
+			*free = strtoull(val, NULL, 10);
+			return false;
+		}
+		return true;
+	});
+
+	return 0;
+}
+
+int
+NumaTopology::load ()
+{
+	char path[128], buf[4096];
+	std::vector< int > ids;
+
+	node_list.clear();
+
+	has_sysfs = (read_attr(SYSFS_NODE "/online", buf, sizeof(buf)) == 0 &&
+	             parse_cpu_list(buf, ids) == 0 && !ids.empty());
+	if (!has_sysfs) {
+		/** no NUMA in this kernel: one node with everything **/
+		NumaNode node;
+
+		node.id = 0;
+		node.distance.push_back(10);
+		node.mem_total = node.mem_free = 0;
+		if (read_attr(SYSFS_CPU "/online", buf, sizeof(buf)) == 0)
+			parse_cpu_list(buf, node.cpus);
+		readMemory(0, &node.mem_total, &node.mem_free);
+		node_list.push_back(node);
+		return 0;
+	}
+
+	for (size_t i(0); i < ids.size(); i++) {
+		NumaNode node;
+		const char *p;
+		char *end;
+
+		node.id = ids[i];
+		node.mem_total = node.mem_free = 0;
+
+		snprintf(path, sizeof(path), SYSFS_NODE "/node%d/cpulist", node.id);
+		if (read_attr(path, buf, sizeof(buf)) == 0)
+			parse_cpu_list(buf, node.cpus);
+
+		snprintf(path, sizeof(path), SYSFS_NODE "/node%d/distance", node.id);
+		if (read_attr(path, buf, sizeof(buf)) == 0) {
+			for (p = buf; *p; p = end) {
+				const long d = strtol(p, &end, 10);
+
+				if (end == p)
+					break;
+				node.distance.push_back((int)d);
+			}
+		}
+
+		readMemory(node.id, &node.mem_total, &node.mem_free);
+		node_list.push_back(node);
+	}
+
+	return 0;
+}
+
+int
+NumaTopology::refreshMemory ()
+{
+	int ret = 0;
+
+	for (size_t i(0); i < node_list.size(); i++) {
+		if (readMemory(node_list[i].id, &node_list[i].mem_total, 
+		               &node_list[i].mem_free) < 0)
+			ret = -1;
+	}
+	return ret;
+}
+
+int
+NumaTopology::indexOf (const int node) const
+{
+	for (size_t i(0); i < node_list.size(); i++) {
+		if (node_list[i].id == node)
+			return (int)i;
+	}
+	return -1;
+}
+
+int
+NumaTopology::nodeOfCpu (const int cpu) const
+{
+	for (size_t i(0); i < node_list.size(); i++) {
+		for (size_t c(0); c < node_list[i].cpus.size(); c++) {
+			if (node_list[i].cpus[c] == cpu)
+				return node_list[i].id;
+		}
+	}
+	return -1;
+}
+
+int
+NumaTopology::distance (const int from, const int to) const
+{
+	const int f = indexOf(from), t = indexOf(to);
+
+	if (f < 0 || t < 0 || (size_t)t >= node_list[f].distance.size())
+		return -1;
+	return node_list[f].distance[t];
+}
+
+int numa_maps_usage (const int pid, char *buf, const size_t size, 
+                     std::vector< uint64_t > &bytes)
+{
+	char path[64];
+
+	bytes.clear();
+	snprintf(path, sizeof(path), "/proc/%d/numa_maps", pid);
+
+	/** 
+	 * each mapping reads "<addr> <policy> ... N0=12 N1=3 kernelpagesize_kB=4",
+	 * the page size comes after the counts so hold them until it's seen
+	 */
+	return for_each_line(path, buf, size, [&](const char *line, size_t len) {
+		const char *p = line, *end = line + len;
+		uint64_t page_kb = 4, pages[64];
+		int max_node = -1;
+
+		while (p < end) {
+			const char *word = p;
+
+			while (p < end && *p != ' ')
+				p++;
+			if (word[0] == 'N' && (unsigned)(word[1] - '0') < 10) {
+				char *eq;
+				const long node = strtol(word + 1, &eq, 10);
+
+				if (*eq == '=' && node >= 0 && node < 64) {
+					for (int n(max_node + 1); n <= node; n++)
+						pages[n] = 0;
+					if (node > max_node)
+						max_node = (int)node;
+					pages[node] += strtoull(eq + 1, NULL, 10);
+				}
+			}
+			else if (p - word > 18 && !memcmp(word, "kernelpagesize_kB=", 18)) {
+				page_kb = strtoull(word + 18, NULL, 10);
+			}
+			while (p < end && *p == ' ')
+				p++;
+		}
+
+		if ((size_t)(max_node + 1) > bytes.size())
+			bytes.resize(max_node + 1, 0);
+		for (int n(0); n <= max_node; n++)
+			bytes[n] += pages[n] * page_kb * 1024;
+		return true;
+	});
+}
@@ -0,0 +1,180 @@
+/**
+ * topology.hpp - 
+ * @author: Jonathan Beard
+ * @version: Sat Oct 17 10:12:44 2026
+ * 
+ * Copyright 2014 Jonathan Beard
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _TOPOLOGY_HPP_
+#define _TOPOLOGY_HPP_  1
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "systeminfo.hpp"
+
+/**
+ * parse_cpu_list - expand a sysfs cpu list such as "0-3,8,10-11"
+ * into the individual ids, in the order given.
+ * @return  int - 0 on success, -1 on a malformed list
+ */
+int parse_cpu_list (const char *list, std::vector< int > &ids);
+
+enum CacheType {
+   CacheData = 0,
+   CacheInstruction,
+   CacheUnified
+};
+
+/**
+ * CacheInfo - one cache as seen from a cpu, from
+ * /sys/devices/system/cpu/cpuN/cache/indexM.
+ */
+struct CacheInfo {
+   int              level;
+   CacheType        type;
+   uint64_t         size;        /* bytes */
+   int              ways;        /* ways_of_associativity */
+   int              line_size;   /* coherency_line_size, bytes */
+   std::vector< int > shared_cpus; /* every cpu sharing this cache, itself included */
+};
+
+/**
+ * CacheTopology - the caches of every cpu on the host as
+ * reported by sysfs.  Unlike sysconf(_SC_LEVEL*) this works with
+ * static binaries and also says which cpus share each cache.
+ */
+class CacheTopology
+{
+public:
+   CacheTopology() = default;
+
+   /**
+    * load - parse sysfs for every cpu, or only for cpu when it
+    * is not negative.
+    * @return  int - 0 on success, -1 if no cache info was found
+    */
+   int load (const int cpu = -1);
+
+   /**
+    * cpus - ids of the cpus that have been loaded.
+    */
+   const std::vector< int > &cpus () const { return cpu_ids; }
+
+   /**
+    * caches - every cache of cpu, empty if unknown.
+    */
+   const std::vector< CacheInfo > &caches (const int cpu) const;
+
+   /**
+    * find - the cache of cpu at level, the data or unified one
+    * unless type asks for the instruction cache.
+    * @return  const CacheInfo * - NULL if there is none
+    */
+   const CacheInfo *find (const int cpu, const int level, 
+                          const CacheType type = CacheData) const;
+
+   /**
+    * sharing - cpus that share cpu's data/unified cache at level,
+    * e.g. sharing(cpu, 3) gives the cores on the same L3.
+    */
+   std::vector< int > sharing (const int cpu, const int level) const;
+
+   /**
+    * traitValue - value of one of the Level* cache traits for
+    * cpu, in the units sysconf uses.
+    * @return  long - -1 if the cache isn't there
+    */
+   long traitValue (const Trait trait, const int cpu = 0) const;
+
+private:
+   int loadCpu (const int cpu);
+
+   std::vector< int >                       cpu_ids;
+   std::vector< std::vector< CacheInfo > >  per_cpu; /* indexed by cpu id */
+};
+
+/**
+ * NumaNode - one memory node from /sys/devices/system/node/nodeN.
+ */
+struct NumaNode {
+   int                id;
+   std::vector< int > cpus;
+   std::vector< int > distance;  /* to every node, in NumaTopology::nodes() order */
+   uint64_t           mem_total; /* kB */
+   uint64_t           mem_free;  /* kB, as of the last load or refreshMemory */
+};
+
+/**
+ * NumaTopology - nodes, their cpus, distances and free memory.
+ * A kernel without NUMA support shows up as a single node 0 that
+ * holds every cpu.
+ */
+class NumaTopology
+{
+public:
+   NumaTopology() = default;
+
+   /**
+    * load - read every node's cpulist, distance and meminfo.
+    * @return  int - 0 on success, -1 on failure
+    */
+   int load ();
+
+   /**
+    * refreshMemory - re-read only the per-node meminfo.
+    * @return  int - 0 on success, -1 on failure
+    */
+   int refreshMemory ();
+
+   const std::vector< NumaNode > &nodes () const { return node_list; }
+
+   /**
+    * nodeOfCpu - id of the node holding cpu, -1 if unknown.
+    */
+   int nodeOfCpu (const int cpu) const;
+
+   /**
+    * distance - SLIT distance between two node ids, -1 if unknown.
+    */
+   int distance (const int from, const int to) const;
+
+   /**
+    * indexOf - position of node id in nodes(), -1 if unknown.
+    */
+   int indexOf (const int node) const;
+
+   /**
+    * readMemory - current total and free kB of node, read fresh
+    * without touching the cached nodes().
+    * @return  int - 0 on success, -1 on failure
+    */
+   int readMemory (const int node, uint64_t *total, uint64_t *free) const;
+
+private:
+   std::vector< NumaNode > node_list;
+   bool                    has_sysfs = false;
+};
+
+/**
+ * numa_maps_usage - bytes of pid's memory resident on each node,
+ * summed over /proc/<pid>/numa_maps which is streamed through buf
+ * rather than read whole.  bytes is indexed by node id.
+ * @return  int - 0 on success, -1 on failure
+ */
+int numa_maps_usage (const int pid, char *buf, const size_t size, 
+                     std::vector< uint64_t > &bytes);
+
+#endif /* END _TOPOLOGY_HPP_ */